@@ -0,0 +1,123 @@
+/************************************************************************************[Benchmark.cc]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#include <sstream>
+#include <map>
+#include <limits>
+#include <algorithm>
+
+#include "Benchmark.h"
+
+using namespace RcpsptHeuristic;
+
+void Benchmark::writeTrajectory(const Trajectory& trajectory, std::ostream& output) {
+    output << trajectory.instance << ' ' << trajectory.config << ' ' << trajectory.improvements.size();
+    for (const Improvement& improvement : trajectory.improvements)
+        output << ' ' << improvement.milis << ' ' << improvement.makespan;
+    output << std::endl;
+}
+
+std::vector<Trajectory> Benchmark::readTrajectories(std::istream& input) {
+    std::vector<Trajectory> trajectories;
+    std::string line;
+    while (std::getline(input, line)) {
+        if (line.empty()) continue;
+        std::istringstream tokens(line);
+        Trajectory trajectory;
+        int n;
+        tokens >> trajectory.instance >> trajectory.config >> n;
+        if (!tokens || n < 0) continue;
+        trajectory.improvements.resize(n);
+        for (int i = 0; i < n; i++) tokens >> trajectory.improvements[i].milis >> trajectory.improvements[i].makespan;
+        if (tokens) trajectories.push_back(trajectory);
+    }
+    return trajectories;
+}
+
+void Benchmark::compare(const std::vector<std::string>& labels, const std::vector<std::vector<Trajectory>>& runs,
+                        std::ostream& output) {
+    const double INF = std::numeric_limits<double>::infinity();
+    int nruns = (int)runs.size();
+
+    // Determine the target for each instance: the best makespan found by any of the runs
+    std::map<std::string, int> targets;
+    for (const std::vector<Trajectory>& run : runs) {
+        for (const Trajectory& trajectory : run) {
+            if (trajectory.improvements.empty()) continue;
+            int makespan = trajectory.improvements.back().makespan;
+            auto it = targets.find(trajectory.instance);
+            if (it == targets.end() || makespan < it->second) targets[trajectory.instance] = makespan;
+        }
+    }
+    int ninstances = (int)targets.size();
+    if (ninstances == 0) {
+        output << "No instances with solutions to compare." << std::endl;
+        return;
+    }
+
+    // Calculate the time-to-target per run and instance (infinite if the target was not reached)
+    std::map<std::string, int> index;
+    for (const auto& target : targets) index[target.first] = (int)index.size();
+    std::vector<std::vector<double>> ttt(nruns, std::vector<double>(ninstances, INF));
+    for (int r = 0; r < nruns; r++) {
+        for (const Trajectory& trajectory : runs[r]) {
+            auto it = targets.find(trajectory.instance);
+            if (it == targets.end()) continue;
+            for (const Improvement& improvement : trajectory.improvements) {
+                if (improvement.makespan <= it->second) {
+                    double& t = ttt[r][index[trajectory.instance]];
+                    t = std::min(t, std::max(improvement.milis, 1e-3)); // Avoid division by zero in the ratios below
+                    break;
+                }
+            }
+        }
+    }
+
+    // Performance profile (Dolan and Moré): fraction of instances on which a run is within a factor tau of the fastest
+    const double taus[] = {1.0, 1.25, 1.5, 2.0, 4.0, 8.0, 16.0, 32.0, INF};
+    output << "performance_profile tau";
+    for (const std::string& label : labels) output << ' ' << label;
+    output << std::endl;
+    for (double tau : taus) {
+        output << "performance_profile " << tau;
+        for (int r = 0; r < nruns; r++) {
+            int count = 0;
+            for (int i = 0; i < ninstances; i++) {
+                double fastest = INF;
+                for (int s = 0; s < nruns; s++) fastest = std::min(fastest, ttt[s][i]);
+                if (ttt[r][i] < INF && ttt[r][i] <= tau * fastest) count++;
+            }
+            output << ' ' << (double)count / ninstances;
+        }
+        output << std::endl;
+    }
+
+    // Time-to-target distributions: empirical cumulative probability of reaching the target within a time
+    for (int r = 0; r < nruns; r++) {
+        std::vector<double> times;
+        for (double t : ttt[r]) if (t < INF) times.push_back(t);
+        std::sort(times.begin(), times.end());
+        output << "ttt " << labels[r] << " reached " << times.size() << '/' << ninstances << std::endl;
+        for (int i = 0; i < (int)times.size(); i++)
+            output << "ttt " << labels[r] << ' ' << times[i] << ' ' << (i + 0.5) / ninstances << std::endl;
+    }
+}
@@ -0,0 +1,79 @@
+/*************************************************************************************[Benchmark.h]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#ifndef RCPSPT_HEURISTIC_BENCHMARK_H
+#define RCPSPT_HEURISTIC_BENCHMARK_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Solver.h"
+
+namespace RcpsptHeuristic {
+
+/**
+ * Anytime profile of a single solver run: the improvements of the incumbent over time.
+ */
+struct Trajectory {
+    std::string instance;                  // Instance name (file name without extension)
+    std::string config;                    // Solver configuration (see PrSolver::getConfig())
+    std::vector<Improvement> improvements; // Improvements of the incumbent, in chronological order
+};
+
+/**
+ * Class containing functions for recording and comparing anytime profiles of solver runs.
+ */
+class Benchmark {
+public:
+    /**
+     * Writes a trajectory as a single line "[instance] [config] [n] [milis 1] [makespan 1] ... [milis n] [makespan n]".
+     *
+     * @param trajectory the trajectory to write
+     * @param output the stream to write to
+     */
+    static void writeTrajectory(const Trajectory& trajectory, std::ostream& output);
+
+    /**
+     * Reads all trajectories that were written by writeTrajectory().
+     *
+     * @param input the stream to read from
+     * @return the trajectories that were read
+     */
+    static std::vector<Trajectory> readTrajectories(std::istream& input);
+
+    /**
+     * Compares sets of runs (e.g. of different builds or configurations) on the same instances. For each instance,
+     * the target is the best makespan found by any of the runs. Writes a performance profile over the times-to-target
+     * (fraction of instances on which a run is within a factor tau of the fastest run), followed by the time-to-target
+     * distribution of each run.
+     *
+     * @param labels a label for each set of runs
+     * @param runs the trajectories of each set of runs
+     * @param output the stream to write to
+     */
+    static void compare(const std::vector<std::string>& labels, const std::vector<std::vector<Trajectory>>& runs,
+                        std::ostream& output);
+};
+}
+
+#endif //RCPSPT_HEURISTIC_BENCHMARK_H
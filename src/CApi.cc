@@ -0,0 +1,223 @@
+/*****************************************************************************************[CApi.cc]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+#include "CApi.h"
+#include "Parser.h"
+#include "Solver.h"
+#include "ResultFile.h"
+
+using namespace RcpsptHeuristic;
+
+struct rcpspt_problem {
+    Problem* problem;
+};
+
+struct rcpspt_solver {
+    explicit rcpspt_solver(Problem& problem)
+        : solver(problem), schedule(problem.njobs), status(RCPSPT_ERROR), milis(0.0), timeLimit(0) {}
+
+    PrSolver solver;
+    std::vector<int> schedule; // End times of the last schedule that was found
+    std::string config;        // Storage for the string returned by rcpspt_solver_config()
+    int status;                // Status of the last solve
+    double milis;              // Wall-clock time of the last solve
+    int timeLimit;             // Time limit of the configuration
+    std::vector<EliteSchedule> elite; // Elite pool of the last solve
+};
+
+struct rcpspt_results {
+    explicit rcpspt_results(const char* path) : reader(path) {}
+
+    ResultReader reader;
+};
+
+rcpspt_problem* rcpspt_problem_create(int njobs, int horizon, int nresources, const int* durations,
+                                      const int* nsuccessors, const int* successors, const int* requests,
+                                      const int* capacities) {
+    if (njobs < 2 || horizon < 1 || nresources < 0 || durations == nullptr || nsuccessors == nullptr ||
+        (successors == nullptr && njobs > 1) || capacities == nullptr)
+        return nullptr;
+    for (int job = 0, offset = 0; job < njobs; offset += nsuccessors[job++]) {
+        if (durations[job] < 0 || durations[job] > horizon || nsuccessors[job] < 0) return nullptr;
+        for (int i = 0; i < nsuccessors[job]; i++)
+            if (successors[offset + i] <= job || successors[offset + i] >= njobs) return nullptr;
+    }
+
+    try {
+        Problem* problem = new Problem(njobs, horizon, nresources);
+        const int* request = requests;
+        for (int job = 0; job < njobs; job++) {
+            problem->nsuccessors[job] = nsuccessors[job];
+            problem->successors[job] = new int[nsuccessors[job]];
+            for (int i = 0; i < nsuccessors[job]; i++) {
+                problem->successors[job][i] = *successors++;
+                problem->predecessors[problem->successors[job][i]].push_back(job);
+            }
+            problem->durations[job] = durations[job];
+            for (int k = 0; k < nresources; k++) {
+                problem->requests[job][k] = new int[durations[job]];
+                for (int t = 0; t < durations[job]; t++)
+                    problem->requests[job][k][t] = requests != nullptr ? *request++ : 0;
+            }
+        }
+        for (int k = 0; k < nresources; k++)
+            for (int t = 0; t < horizon; t++) problem->capacities[k][t] = capacities[k * horizon + t];
+        problem->indexRequests();
+        problem->compressCapacities();
+        return new rcpspt_problem{problem};
+    }
+    catch (...) {
+        return nullptr;
+    }
+}
+
+rcpspt_problem* rcpspt_problem_load(const char* path) {
+    if (path == nullptr) return nullptr;
+    std::ifstream input(path);
+    if (!input) return nullptr;
+    try {
+        return new rcpspt_problem{new Problem(Parser::parseProblemInstance(input))};
+    }
+    catch (...) {
+        return nullptr;
+    }
+}
+
+int rcpspt_problem_njobs(const rcpspt_problem* problem) {
+    return problem != nullptr ? problem->problem->njobs : 0;
+}
+
+void rcpspt_problem_destroy(rcpspt_problem* problem) {
+    if (problem == nullptr) return;
+    delete problem->problem;
+    delete problem;
+}
+
+rcpspt_solver* rcpspt_solver_create(rcpspt_problem* problem) {
+    if (problem == nullptr) return nullptr;
+    try {
+        return new rcpspt_solver(*problem->problem);
+    }
+    catch (...) {
+        return nullptr;
+    }
+}
+
+void rcpspt_solver_destroy(rcpspt_solver* solver) {
+    delete solver;
+}
+
+int rcpspt_solver_configure(rcpspt_solver* solver, const char* config) {
+    if (solver == nullptr || config == nullptr) return -1;
+    bool applied = solver->solver.configure(config);
+    solver->timeLimit = solver->solver.getTimeLimit();
+    return applied ? 0 : -1;
+}
+
+const char* rcpspt_solver_config(rcpspt_solver* solver) {
+    if (solver == nullptr) return nullptr;
+    solver->config = solver->solver.getConfig();
+    return solver->config.c_str();
+}
+
+int rcpspt_solver_solve(rcpspt_solver* solver, int deadline) {
+    if (solver == nullptr || deadline < 0) return RCPSPT_ERROR;
+    solver->solver.setTimeLimit(deadline > 0 ? deadline : solver->timeLimit);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bool infeasible = false;
+    try {
+        bool found = solver->solver.solve(solver->schedule.data(), &infeasible);
+        solver->status = found ? RCPSPT_FOUND : infeasible ? RCPSPT_INFEASIBLE : RCPSPT_NO_SOLUTION;
+    }
+    catch (...) {
+        solver->status = RCPSPT_ERROR;
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    solver->milis = elapsed.count();
+    solver->elite = solver->solver.getElite();
+    solver->solver.setTimeLimit(solver->timeLimit);
+    return solver->status;
+}
+
+const int* rcpspt_solver_schedule(const rcpspt_solver* solver) {
+    if (solver == nullptr || solver->status != RCPSPT_FOUND) return nullptr;
+    return solver->schedule.data();
+}
+
+void rcpspt_solver_stats(const rcpspt_solver* solver, rcpspt_stats* out) {
+    if (out == nullptr) return;
+    *out = rcpspt_stats{RCPSPT_ERROR, 0, 0, 0.0, 0};
+    if (solver == nullptr) return;
+    out->status = solver->status;
+    if (solver->status == RCPSPT_FOUND) out->makespan = solver->schedule.back();
+    if (solver->status == RCPSPT_FOUND || solver->status == RCPSPT_NO_SOLUTION)
+        out->lower_bound = solver->solver.getLowerBound();
+    out->milis = solver->milis;
+    out->improvements = (int)solver->solver.getTrajectory().size();
+}
+
+int rcpspt_solver_elite_count(const rcpspt_solver* solver) {
+    return solver != nullptr ? (int)solver->elite.size() : 0;
+}
+
+const int* rcpspt_solver_elite(const rcpspt_solver* solver, int index) {
+    if (solver == nullptr || index < 0 || index >= (int)solver->elite.size()) return nullptr;
+    return solver->elite[index].schedule.data();
+}
+
+rcpspt_results* rcpspt_results_open(const char* path) {
+    if (path == nullptr) return nullptr;
+    try {
+        rcpspt_results* results = new rcpspt_results(path);
+        if (!results->reader.isOpen()) {
+            delete results;
+            return nullptr;
+        }
+        return results;
+    }
+    catch (...) {
+        return nullptr;
+    }
+}
+
+long rcpspt_results_count(const rcpspt_results* results) {
+    return results != nullptr ? (long)results->reader.size() : 0;
+}
+
+int rcpspt_results_get(const rcpspt_results* results, long index, rcpspt_result* out) {
+    if (results == nullptr || out == nullptr || index < 0 || index >= (long)results->reader.size()) return -1;
+    ResultRecord record = results->reader.get((size_t)index);
+    *out = rcpspt_result{record.name.data(), (int)record.name.size(), (int)record.status, record.makespan,
+                         record.milis, record.njobs, record.schedule};
+    return 0;
+}
+
+void rcpspt_results_close(rcpspt_results* results) {
+    delete results;
+}
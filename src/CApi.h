@@ -0,0 +1,178 @@
+/******************************************************************************************[CApi.h]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#ifndef RCPSPT_HEURISTIC_CAPI_H
+#define RCPSPT_HEURISTIC_CAPI_H
+
+/*
+ * C interface to the tournament-based solver, for callers through a foreign function interface. Problems and solvers
+ * are opaque handles. A solver keeps a reference to its problem, so the problem must outlive the solver. Functions
+ * do not throw: failures are reported by return values.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct rcpspt_problem rcpspt_problem;
+typedef struct rcpspt_solver rcpspt_solver;
+typedef struct rcpspt_results rcpspt_results;
+
+/* Result of a solve */
+enum rcpspt_status {
+    RCPSPT_FOUND = 0,       /* A schedule was found */
+    RCPSPT_INFEASIBLE = 1,  /* Preprocessing found the instance to be infeasible */
+    RCPSPT_NO_SOLUTION = 2, /* No schedule was found */
+    RCPSPT_ERROR = 3        /* Invalid arguments */
+};
+
+/* Statistics of the last solve */
+typedef struct rcpspt_stats {
+    int status;        /* Status of the last solve (rcpspt_status), or RCPSPT_ERROR if there was none */
+    int makespan;      /* Makespan of the schedule, if one was found */
+    int lower_bound;   /* Lower bound on the makespan, if the instance was not found to be infeasible */
+    double milis;      /* Wall-clock time of the solve */
+    int improvements;  /* Number of improvements of the incumbent */
+} rcpspt_stats;
+
+/* Record of a binary result file, pointing into the memory of the file */
+typedef struct rcpspt_result {
+    const char* name;       /* Instance name (not null-terminated) */
+    int name_length;        /* Length of the name in bytes */
+    int status;             /* Status of the solve (rcpspt_status) */
+    int makespan;           /* Makespan, or -1 if no schedule was found */
+    long milis;             /* Solve time in milliseconds */
+    int njobs;              /* Number of end times in schedule */
+    const int* schedule;    /* End times for all activities, or NULL if no schedule was found */
+} rcpspt_result;
+
+/**
+ * Creates a problem from arrays.
+ *
+ * @param njobs number of activities, including the dummy source (first) and sink (last)
+ * @param horizon planning horizon
+ * @param nresources number of renewable resources
+ * @param durations duration of each activity
+ * @param nsuccessors number of successors of each activity
+ * @param successors successors of all activities, concatenated in order of the activities
+ * @param requests request per time step, per resource, per activity, concatenated (durations[j] values per resource
+ *        for activity j)
+ * @param capacities capacity per time step, per resource, concatenated (horizon values per resource)
+ * @return the problem, or NULL if the arguments are invalid
+ */
+rcpspt_problem* rcpspt_problem_create(int njobs, int horizon, int nresources, const int* durations,
+                                      const int* nsuccessors, const int* successors, const int* requests,
+                                      const int* capacities);
+
+/**
+ * Loads a problem from a .smt file.
+ *
+ * @return the problem, or NULL if the file cannot be read or is not a valid instance file
+ */
+rcpspt_problem* rcpspt_problem_load(const char* path);
+
+/**
+ * @return the number of activities of the problem
+ */
+int rcpspt_problem_njobs(const rcpspt_problem* problem);
+
+void rcpspt_problem_destroy(rcpspt_problem* problem);
+
+/**
+ * Creates a solver for a problem, with the default configuration.
+ */
+rcpspt_solver* rcpspt_solver_create(rcpspt_problem* problem);
+
+void rcpspt_solver_destroy(rcpspt_solver* solver);
+
+/**
+ * Configures a solver with comma-separated settings, in the format of rcpspt_solver_config() (the "pr:" prefix is
+ * optional): passes=n, threads=n, layout=time-major, decompose, contract, rolling=window:look-ahead, time=milis,
+ * seed=n, elite=size[:distance], relink.
+ *
+ * @return 0 on success, -1 if a setting is not recognised (the settings before it are applied)
+ */
+int rcpspt_solver_configure(rcpspt_solver* solver, const char* config);
+
+/**
+ * @return the configuration of the solver, owned by the solver and valid until the next call on it
+ */
+const char* rcpspt_solver_config(rcpspt_solver* solver);
+
+/**
+ * Solves the problem, stopping the passes after the deadline.
+ *
+ * @param deadline time limit in milliseconds, or 0 for the time limit of the configuration
+ * @return the status (rcpspt_status)
+ */
+int rcpspt_solver_solve(rcpspt_solver* solver, int deadline);
+
+/**
+ * @return the end times of all activities of the last schedule that was found (without copying), owned by the solver
+ *         and valid until the next solve or its destruction, or NULL if no schedule was found
+ */
+const int* rcpspt_solver_schedule(const rcpspt_solver* solver);
+
+/**
+ * Writes the statistics of the last solve.
+ */
+void rcpspt_solver_stats(const rcpspt_solver* solver, rcpspt_stats* out);
+
+/**
+ * @return the number of schedules in the elite pool of the last solve (0 unless configured with elite=size)
+ */
+int rcpspt_solver_elite_count(const rcpspt_solver* solver);
+
+/**
+ * @param index the index of the schedule, by increasing makespan
+ * @return the end times of all activities of a schedule of the elite pool (without copying), owned by the solver and
+ *         valid until the next solve or its destruction, or NULL if the index is out of range
+ */
+const int* rcpspt_solver_elite(const rcpspt_solver* solver, int index);
+
+/**
+ * Opens a binary result file (as written by the batch mode with --results) by mapping it into memory.
+ *
+ * @return the result file, or NULL if it cannot be read or is not a complete result file
+ */
+rcpspt_results* rcpspt_results_open(const char* path);
+
+/**
+ * @return the number of records of the result file
+ */
+long rcpspt_results_count(const rcpspt_results* results);
+
+/**
+ * Gets a record of a result file (without copying), valid until the result file is closed.
+ *
+ * @param index the index of the record, in the order in which they were written
+ * @return 0 on success, -1 if the index is out of range
+ */
+int rcpspt_results_get(const rcpspt_results* results, long index, rcpspt_result* out);
+
+void rcpspt_results_close(rcpspt_results* results);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //RCPSPT_HEURISTIC_CAPI_H
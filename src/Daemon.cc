@@ -0,0 +1,287 @@
+/***************************************************************************************[Daemon.cc]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include "Daemon.h"
+#include "Metrics.h"
+#include "Parser.h"
+
+using namespace RcpsptHeuristic;
+
+/**
+ * Decodes a URL-encoded query value ('+' and percent escapes).
+ */
+static std::string decode(const std::string& value) {
+    std::string result;
+    for (size_t i = 0; i < value.size(); i++) {
+        if (value[i] == '+') result.push_back(' ');
+        else if (value[i] == '%' && i + 2 < value.size() && isxdigit(value[i + 1]) && isxdigit(value[i + 2])) {
+            result.push_back((char)std::stoi(value.substr(i + 1, 2), nullptr, 16));
+            i += 2;
+        }
+        else result.push_back(value[i]);
+    }
+    return result;
+}
+
+/**
+ * @return the decoded value of a parameter of a query string, or an empty string if it is missing
+ */
+static std::string parameter(const std::string& query, const std::string& name) {
+    size_t begin = 0;
+    while (begin < query.size()) {
+        size_t end = query.find('&', begin);
+        if (end == std::string::npos) end = query.size();
+        size_t equals = query.find('=', begin);
+        if (equals < end && query.compare(begin, equals - begin, name) == 0)
+            return decode(query.substr(equals + 1, end - equals - 1));
+        begin = end + 1;
+    }
+    return "";
+}
+
+Daemon::Daemon(int port, int nthreads, int slice)
+    : port(port),
+      nthreads(std::max(nthreads, 1)),
+      outstanding(0),
+      queuedMilis(0),
+      passFactor(1e-5),
+      executor(nthreads, slice) {}
+
+bool Daemon::run() {
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0) return false;
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons((uint16_t)port);
+    if (bind(listener, (sockaddr*)&address, sizeof(address)) < 0 || listen(listener, SOMAXCONN) < 0) {
+        close(listener);
+        return false;
+    }
+
+    while (true) {
+        int connection = accept(listener, nullptr, nullptr);
+        if (connection < 0) {
+            close(listener);
+            return false;
+        }
+        std::thread(&Daemon::handle, this, connection).detach();
+    }
+}
+
+void Daemon::handle(int connection) {
+    // Read the request line (the headers are ignored)
+    std::string request;
+    char buffer[4096];
+    while (request.find("\r\n") == std::string::npos && request.find('\n') == std::string::npos &&
+           request.size() < 65536) {
+        ssize_t n = read(connection, buffer, sizeof(buffer));
+        if (n <= 0) break;
+        request.append(buffer, (size_t)n);
+    }
+    std::istringstream line(request.substr(0, request.find_first_of("\r\n")));
+    std::string method, target;
+    line >> method >> target;
+    size_t question = target.find('?');
+    std::string path = target.substr(0, question);
+    std::string query = question != std::string::npos ? target.substr(question + 1) : "";
+
+    int code = 200;
+    std::string contentType = "text/plain";
+    std::string body;
+    if (method != "GET") {
+        code = 405;
+        body = "Only GET is supported\n";
+    }
+    else if (path == "/metrics") {
+        std::ostringstream output;
+        Metrics::write(output, executor.pending());
+        body = output.str();
+        contentType = "text/plain; version=0.0.4";
+    }
+    else if (path == "/solve") body = solve(query, &code);
+    else {
+        code = 404;
+        body = "Not found\n";
+    }
+
+    std::ostringstream response;
+    response << "HTTP/1.0 " << code << (code == 200 ? " OK" : code == 400 ? " Bad Request" : code == 404 ?
+                                        " Not Found" : code == 405 ? " Method Not Allowed" : " Service Unavailable")
+             << "\r\n";
+    response << "Content-Type: " << contentType << "\r\n";
+    response << "Content-Length: " << body.size() << "\r\n\r\n" << body;
+    std::string data = response.str();
+    for (size_t sent = 0; sent < data.size();) {
+        ssize_t n = write(connection, data.data() + sent, data.size() - sent);
+        if (n <= 0) break;
+        sent += (size_t)n;
+    }
+    close(connection);
+}
+
+std::string Daemon::solve(const std::string& query, int* code) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::string instancePath = parameter(query, "path");
+    std::string config = parameter(query, "config");
+    int priority = 0, deadline = 0;
+    try {
+        std::string value = parameter(query, "priority");
+        if (!value.empty()) priority = std::stoi(value);
+        value = parameter(query, "deadline");
+        if (!value.empty()) deadline = std::max(std::stoi(value), 0);
+    }
+    catch (const std::exception&) { // Invalid number
+        Metrics::add(Counter::RequestsFailed);
+        *code = 400;
+        return "Invalid priority or deadline\n";
+    }
+    std::ifstream input(instancePath);
+    if (!input) {
+        Metrics::add(Counter::RequestsFailed);
+        *code = 400;
+        return "Can't open input file\n";
+    }
+    std::unique_ptr<Problem> parsed;
+    try {
+        parsed.reset(new Problem(Parser::parseProblemInstance(input)));
+    }
+    catch (const std::exception&) { // Not an instance file
+        Metrics::add(Counter::RequestsFailed);
+        *code = 400;
+        return "Invalid instance file\n";
+    }
+    input.close();
+    Problem& problem = *parsed;
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    Metrics::observe(Phase::Parse, elapsed.count());
+
+    PrSolver settings(problem);
+    if (!settings.configure(config)) {
+        Metrics::add(Counter::RequestsFailed);
+        *code = 400;
+        return "Invalid config\n";
+    }
+    if (settings.getPasses() > MAX_PASSES) {
+        Metrics::add(Counter::RequestsFailed);
+        *code = 400;
+        return "Too many passes\n";
+    }
+
+    // Admission: shrink the pass budget to the share of the threads, and to what fits before the deadline
+    int requested = settings.getPasses();
+    int minimum = std::min(std::max(requested / MAX_SHRINK, 1), requested);
+    // A pass costs time even without resources, and the estimate and calibration below must not divide by zero
+    double units = (double)problem.njobs * problem.horizon * std::max(problem.nresources, 1);
+    int passes = requested;
+    double estimate = 0;
+    {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        double passMilis = passFactor * units;
+        if (outstanding >= nthreads) passes = std::max((int)((long)requested * nthreads / (outstanding + 1)), minimum);
+        if (deadline > 0) {
+            double available = deadline - elapsed.count() - queuedMilis / nthreads;
+            if (available < passes * passMilis) passes = (int)std::max(available / passMilis, -1.0);
+        }
+        if (passes >= minimum) {
+            estimate = passes * passMilis;
+            outstanding++;
+            queuedMilis += estimate;
+        }
+    }
+    if (passes < minimum) {
+        Metrics::add(Counter::RequestsRejected);
+        *code = 503;
+        return "Rejected: the deadline can't be met\n";
+    }
+    if (passes < requested) Metrics::add(Counter::DegradedRequests);
+
+    std::chrono::steady_clock::time_point due = deadline > 0 ? start + std::chrono::milliseconds(deadline)
+                                                             : std::chrono::steady_clock::time_point::max();
+    std::shared_ptr<SolveHandle> handle = executor.submit(problem, [&config, passes, deadline, due](PrSolver& solver) {
+        solver.configure(config);
+        solver.setThreads(1); // The executor threads are the only ones that admission control accounts for
+        solver.setPasses(passes);
+        if (deadline > 0) { // The time that remains after waiting in the queue
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(due - std::chrono::steady_clock::now());
+            int limit = (int)std::max(remaining.count(), (std::chrono::milliseconds::rep)1);
+            if (solver.getTimeLimit() == 0 || limit < solver.getTimeLimit()) solver.setTimeLimit(limit);
+        }
+    }, nullptr, priority, due);
+    SolveStatus status = handle->result.get();
+    elapsed = std::chrono::steady_clock::now() - start;
+
+    // Release the estimate and calibrate the cost of a pass on the measured one
+    {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        outstanding--;
+        queuedMilis = std::max(queuedMilis - estimate, 0.0);
+        if (handle->getPassCount() > 0)
+            passFactor = 0.8 * passFactor + 0.2 * handle->getPassTime() / handle->getPassCount() / units;
+    }
+
+    std::ostringstream output;
+    const std::vector<int>& schedule = handle->getSchedule();
+    if (status == SolveStatus::Found) {
+        std::chrono::steady_clock::time_point validateStart = std::chrono::steady_clock::now();
+        std::string error;
+        bool valid = problem.validate(schedule.data(), &error);
+        std::chrono::duration<double, std::milli> validateTime = std::chrono::steady_clock::now() - validateStart;
+        Metrics::observe(Phase::Validate, validateTime.count());
+        if (!valid) {
+            Metrics::add(Counter::RequestsFailed);
+            output << "status invalid\nerror " << error << "\n";
+            return output.str();
+        }
+    }
+
+    switch (status) {
+        case SolveStatus::Found: Metrics::add(Counter::RequestsFound); output << "status found\n"; break;
+        case SolveStatus::Infeasible: Metrics::add(Counter::RequestsInfeasible); output << "status infeasible\n"; break;
+        case SolveStatus::Cancelled: Metrics::add(Counter::RequestsCancelled); output << "status cancelled\n"; break;
+        default: Metrics::add(Counter::RequestsNoSolution); output << "status no-solution\n"; break;
+    }
+    output << "config " << handle->getConfig() << "\n";
+    output << "passes " << handle->getPassCount() << " of " << requested << "\n";
+    if (status == SolveStatus::Found) output << "makespan " << schedule[problem.njobs - 1] << "\n";
+    output << "milis " << (long)elapsed.count() << "\n";
+    if (status == SolveStatus::Found) {
+        output << "schedule";
+        for (int end : schedule) output << " " << end;
+        output << "\n";
+    }
+    return output.str();
+}
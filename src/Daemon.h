@@ -0,0 +1,84 @@
+/****************************************************************************************[Daemon.h]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+
+#ifndef RCPSPT_HEURISTIC_DAEMON_H
+#define RCPSPT_HEURISTIC_DAEMON_H
+
+#include <string>
+#include <mutex>
+
+#include "Executor.h"
+
+namespace RcpsptHeuristic {
+
+/**
+ * Minimal HTTP/1.0 server on the loopback interface, that solves instances on an Executor and exposes metrics:
+ * - GET /solve?path=[instance file]&config=[settings]&priority=[n]&deadline=[milis]: solves the instance with the
+ *   settings (see PrSolver::configure()), and responds with the lines "status [status]", "passes [passes]",
+ *   "makespan [makespan]", "milis [milis]" and "schedule [end time]...". Solves with a higher priority (default 0)
+ *   run first, then those with the earliest deadline (relative to the request, default none).
+ * - GET /metrics: responds with the metrics of the process, in the Prometheus text format (see Metrics::write()).
+ * Each connection is handled on its own thread.
+ *
+ * Admission control keeps the latency bounded under load. The cost of a pass is estimated as proportional to
+ * njobs * horizon * nresources, with a factor that is calibrated on the passes of earlier solves. The pass budget of
+ * a request shrinks when more solves are outstanding than there are threads, and further to what fits before its
+ * deadline after the estimated work ahead of it; the deadline also becomes its time limit. A request of which less
+ * than 1/MAX_SHRINK of the passes fit is rejected (503), as is a request for more than MAX_PASSES passes (400). Each
+ * solve runs on a single thread of the executor, whatever threads its config asks for, so that a request can't start
+ * threads beyond the ones that admission control accounts for.
+ */
+class Daemon {
+public:
+    /**
+     * @param port the TCP port to listen on
+     * @param nthreads the number of threads that run solves
+     * @param slice the number of passes that a solve runs before it yields its thread (see Executor)
+     */
+    Daemon(int port, int nthreads, int slice);
+
+    /**
+     * Accepts connections until an error occurs.
+     *
+     * @return false if the port could not be opened or a connection could not be accepted
+     */
+    bool run();
+
+    static constexpr int MAX_SHRINK = 8;        // Factor by which the pass budget of a request may shrink at most
+    static constexpr int MAX_PASSES = 10000000; // Maximum number of passes of a request
+
+private:
+    void handle(int connection);
+    std::string solve(const std::string& query, int* code);
+
+    const int port;
+    const int nthreads;
+    std::mutex loadMutex;  // Protects the fields below
+    int outstanding;       // Number of admitted solves that have not finished
+    double queuedMilis;    // Estimated time of the passes of the admitted solves that have not finished
+    double passFactor;     // Estimated time of a pass in milliseconds per unit of njobs * horizon * max(nresources, 1)
+    Executor executor;     // Last, so that its threads stop before the fields above are destroyed
+};
+}
+
+#endif //RCPSPT_HEURISTIC_DAEMON_H
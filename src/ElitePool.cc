@@ -0,0 +1,102 @@
+/*************************************************************************************[ElitePool.cc]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "ElitePool.h"
+
+using namespace RcpsptHeuristic;
+
+void ElitePool::reset(int size, long distance, int n) {
+    std::lock_guard<std::mutex> lock(mutex);
+    capacity = std::max(size, 0);
+    minDistance = distance;
+    njobs = n;
+    members.clear();
+    positions.clear();
+    threshold = capacity > 0 ? INT_MAX : INT_MIN;
+}
+
+void ElitePool::activityOrder(const int* schedule, const int* durations, int n, std::vector<int>& order) {
+    order.resize(n);
+    for (int job = 0; job < n; job++) order[job] = job;
+    std::sort(order.begin(), order.end(), [schedule, durations](int a, int b) {
+        int startA = schedule[a] - durations[a], startB = schedule[b] - durations[b];
+        return startA != startB ? startA < startB : a < b;
+    });
+}
+
+bool ElitePool::offer(const int* schedule, const int* durations) {
+    int makespan = schedule[njobs - 1];
+    if (makespan >= threshold.load(std::memory_order_relaxed)) return false;
+
+    EliteSchedule candidate{makespan, std::vector<int>(schedule, schedule + njobs), {}};
+    activityOrder(schedule, durations, njobs, candidate.order);
+    std::vector<int> position(njobs);
+    for (int i = 0; i < njobs; i++) position[candidate.order[i]] = i;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (makespan >= threshold.load(std::memory_order_relaxed)) return false;
+
+    // Find the closest member
+    int closest = -1;
+    long closestDistance = 0;
+    for (int m = 0; m < (int)members.size(); m++) {
+        long distance = 0;
+        for (int job = 0; job < njobs; job++) distance += std::abs(position[job] - positions[m][job]);
+        if (closest < 0 || distance < closestDistance) {
+            closest = m;
+            closestDistance = distance;
+        }
+    }
+
+    if (closest >= 0 && (closestDistance == 0 || closestDistance < minDistance)) { // Too close to a member
+        if (closestDistance == 0 || makespan >= members[closest].makespan) return false;
+        members.erase(members.begin() + closest);
+        positions.erase(positions.begin() + closest);
+    }
+    else if ((int)members.size() == capacity) { // Replace the worst member
+        members.pop_back();
+        positions.pop_back();
+    }
+
+    // Keep the members ordered by makespan (and by arrival for equal makespans)
+    int index = (int)(std::upper_bound(members.begin(), members.end(), makespan,
+                                       [](int m, const EliteSchedule& member) { return m < member.makespan; }) -
+                      members.begin());
+    members.insert(members.begin() + index, std::move(candidate));
+    positions.insert(positions.begin() + index, std::move(position));
+    if ((int)members.size() == capacity) threshold = members.back().makespan;
+    return true;
+}
+
+std::vector<EliteSchedule> ElitePool::get() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return members;
+}
+
+int ElitePool::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return (int)members.size();
+}
@@ -0,0 +1,106 @@
+/**************************************************************************************[ElitePool.h]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+
+#ifndef RCPSPT_HEURISTIC_ELITEPOOL_H
+#define RCPSPT_HEURISTIC_ELITEPOOL_H
+
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <climits>
+
+namespace RcpsptHeuristic {
+
+/**
+ * Schedule of an elite pool.
+ */
+struct EliteSchedule {
+    int makespan;
+    std::vector<int> schedule; // End times for all activities
+    std::vector<int> order;    // Activity list: the activities in order of their start times (ties by index)
+};
+
+/**
+ * Bounded pool of the best schedules that are mutually distinct in their activity order. The distance between two
+ * schedules is the sum over the activities of the difference between their positions in the two activity lists.
+ * A schedule within the minimum distance of a member only replaces that member (if it is better), so that the pool
+ * does not fill up with variants of a single schedule; otherwise it replaces the worst member of a full pool.
+ *
+ * Offers can come from many threads: a schedule that is not better than the worst member of a full pool is rejected
+ * without locking, and the activity list is derived before locking.
+ */
+class ElitePool {
+public:
+    ElitePool() : capacity(0), minDistance(0), njobs(0), threshold(INT_MAX) {}
+
+    /**
+     * Empties the pool and sets its parameters.
+     *
+     * @param size the maximum number of schedules, or 0 to keep none
+     * @param distance the minimum distance between members
+     * @param n the number of activities of the schedules
+     */
+    void reset(int size, long distance, int n);
+
+    /**
+     * Offers a schedule to the pool.
+     *
+     * @param schedule end times for all activities
+     * @param durations the duration of each activity
+     * @return whether the schedule was added
+     */
+    bool offer(const int* schedule, const int* durations);
+
+    /**
+     * @return the members of the pool, by increasing makespan (and by arrival for equal makespans), so that offering
+     *         them in this order to an empty pool restores it
+     */
+    std::vector<EliteSchedule> get() const;
+
+    /**
+     * @return the number of members of the pool
+     */
+    int size() const;
+
+    /**
+     * Computes the activity list of a schedule.
+     *
+     * @param schedule end times for all activities
+     * @param durations the duration of each activity
+     * @param n the number of activities
+     * @param order output vector for the activities in order of their start times (ties by index)
+     */
+    static void activityOrder(const int* schedule, const int* durations, int n, std::vector<int>& order);
+
+private:
+    int capacity;
+    long minDistance;
+    int njobs;
+    std::atomic<int> threshold;              // Makespan of the worst member if the pool is full, INT_MAX otherwise
+    mutable std::mutex mutex;                // Protects the members
+    std::vector<EliteSchedule> members;      // By increasing makespan
+    std::vector<std::vector<int>> positions; // Position of each activity in the activity list of each member
+};
+}
+
+#endif //RCPSPT_HEURISTIC_ELITEPOOL_H
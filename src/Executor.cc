@@ -0,0 +1,175 @@
+/*************************************************************************************[Executor.cc]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#include "Executor.h"
+
+using namespace RcpsptHeuristic;
+
+SolveHandle::SolveHandle(Problem& problem)
+    : problem(problem),
+      state(SolveStatus::Queued),
+      cancelled(false),
+      solver(nullptr),
+      schedule(problem.njobs),
+      passCount(0),
+      passMilis(0) {
+    result = promise.get_future().share();
+}
+
+bool SolveHandle::done() const {
+    return result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+bool SolveHandle::pollIncumbent(int* out) {
+    std::lock_guard<std::mutex> lock(solverMutex);
+    if (solver != nullptr) return solver->pollIncumbent(out);
+    if (state != SolveStatus::Found) return false;
+    for (int i = 0; i < problem.njobs; i++) out[i] = schedule[i];
+    return true;
+}
+
+Executor::Executor(int nthreads, int slice)
+    : slice(slice),
+      stopping(false) {
+    for (int i = 0; i < std::max(nthreads, 1); i++) threads.emplace_back(&Executor::work, this);
+}
+
+Executor::~Executor() {
+    std::deque<Task> pending;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+        std::deque<Task> started;
+        for (Task& task : queue) (task.solver != nullptr ? started : pending).push_back(std::move(task));
+        queue.swap(started);
+    }
+    available.notify_all();
+    for (Task& task : pending) finish(task, SolveStatus::Cancelled);
+    for (std::thread& thread : threads) thread.join();
+}
+
+std::shared_ptr<SolveHandle> Executor::submit(Problem& problem, const std::function<void(PrSolver&)>& configure,
+                                              const std::function<void(SolveHandle&)>& callback, int priority,
+                                              std::chrono::steady_clock::time_point deadline) {
+    std::shared_ptr<SolveHandle> handle(new SolveHandle(problem));
+    Task task;
+    task.handle = handle;
+    task.configure = configure;
+    task.callback = callback;
+    task.priority = priority;
+    task.deadline = deadline;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        enqueue(std::move(task));
+    }
+    available.notify_one();
+    return handle;
+}
+
+void Executor::enqueue(Task&& task) {
+    // Insert behind all solves that go first or are equal, so that equal solves take turns
+    auto position = queue.end();
+    while (position != queue.begin()) {
+        const Task& previous = *(position - 1);
+        if (previous.priority > task.priority ||
+            (previous.priority == task.priority && previous.deadline <= task.deadline)) break;
+        position--;
+    }
+    queue.insert(position, std::move(task));
+}
+
+void Executor::finish(Task& task, SolveStatus status) {
+    task.handle->state = status;
+    task.handle->promise.set_value(status);
+    if (task.callback) task.callback(*task.handle);
+}
+
+void Executor::start(Task& task) {
+    SolveHandle& handle = *task.handle;
+    task.solver.reset(new PrSolver(handle.problem));
+    if (task.configure) task.configure(*task.solver);
+    task.solver->setCancelToken(&handle.cancelled);
+    handle.config = task.solver->getConfig();
+    {
+        std::lock_guard<std::mutex> lock(handle.solverMutex);
+        handle.solver = task.solver.get();
+    }
+    handle.state = SolveStatus::Running;
+}
+
+void Executor::complete(Task& task, bool found) {
+    SolveHandle& handle = *task.handle;
+    {
+        std::lock_guard<std::mutex> lock(handle.solverMutex);
+        handle.solver = nullptr;
+    }
+    handle.passCount = task.solver->getPassCount();
+    handle.passMilis = task.solver->getPassTime();
+    finish(task, found ? SolveStatus::Found : task.infeasible ? SolveStatus::Infeasible : SolveStatus::NoSolution);
+}
+
+int Executor::pending() {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    int n = 0;
+    for (const Task& task : queue) n += task.solver == nullptr;
+    return n;
+}
+
+void Executor::work() {
+    while (true) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            available.wait(lock, [this]() { return stopping || !queue.empty(); });
+            if (queue.empty()) return; // Stopping
+            task = std::move(queue.front());
+            queue.pop_front();
+        }
+
+        SolveHandle& handle = *task.handle;
+        if (task.solver == nullptr) {
+            if (handle.cancelled) {
+                finish(task, SolveStatus::Cancelled);
+                continue;
+            }
+            start(task);
+            if (slice <= 0) {
+                complete(task, task.solver->solve(handle.schedule.data(), &task.infeasible));
+                continue;
+            }
+            if (!task.solver->begin(handle.schedule.data(), &task.infeasible)) {
+                complete(task, task.solver->finish());
+                continue;
+            }
+        }
+
+        // Run a slice of passes, and move the solve to the back of the queue if passes remain
+        if (task.solver->step(slice)) {
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                enqueue(std::move(task));
+            }
+            available.notify_one();
+        }
+        else complete(task, task.solver->finish());
+    }
+}
@@ -0,0 +1,198 @@
+/**************************************************************************************[Executor.h]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#ifndef RCPSPT_HEURISTIC_EXECUTOR_H
+#define RCPSPT_HEURISTIC_EXECUTOR_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <future>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+
+#include "Problem.h"
+#include "Solver.h"
+
+namespace RcpsptHeuristic {
+
+/**
+ * State of an asynchronous solve.
+ */
+enum class SolveStatus {
+    Queued,     // Waiting for a thread of the executor
+    Running,    // Being solved
+    Found,      // Finished with a schedule
+    Infeasible, // Finished, preprocessing found the instance to be infeasible
+    NoSolution, // Finished without a schedule
+    Cancelled   // Cancelled before it started
+};
+
+/**
+ * Handle of a solve that was submitted to an Executor. A solve that is cancelled while running stops after the
+ * current passes, and finishes with the best schedule found so far (if any).
+ */
+class SolveHandle {
+public:
+    /**
+     * @return the current state of the solve
+     */
+    SolveStatus status() const { return state; }
+
+    /**
+     * @return whether the solve has finished (or was cancelled before it started)
+     */
+    bool done() const;
+
+    /**
+     * Blocks until the solve has finished.
+     */
+    void wait() const { result.wait(); }
+
+    /**
+     * Requests cancellation of the solve.
+     */
+    void cancel() { cancelled = true; }
+
+    /**
+     * Copies the best schedule found so far.
+     *
+     * @param out vector to which end times for all activities will be written
+     * @return true if a schedule was found, false otherwise
+     */
+    bool pollIncumbent(int* out);
+
+    /**
+     * @return the end times of the final schedule (only after the solve has finished with status Found)
+     */
+    const std::vector<int>& getSchedule() const { return schedule; }
+
+    /**
+     * @return the solver configuration that was used
+     */
+    const std::string& getConfig() const { return config; }
+
+    /**
+     * @return the number of passes that were run (only after the solve has finished)
+     */
+    int getPassCount() const { return passCount; }
+
+    /**
+     * @return the time in milliseconds that was spent running passes (only after the solve has finished)
+     */
+    double getPassTime() const { return passMilis; }
+
+    std::shared_future<SolveStatus> result; // Becomes ready with the final status when the solve has finished
+
+private:
+    friend class Executor;
+
+    explicit SolveHandle(Problem& problem);
+
+    Problem& problem;
+    std::atomic<SolveStatus> state;
+    std::atomic<bool> cancelled;
+    std::promise<SolveStatus> promise;
+    std::mutex solverMutex;    // Protects solver
+    PrSolver* solver;          // Solver while the solve is running, or nullptr
+    std::vector<int> schedule; // Output vector of the solve
+    std::string config;
+    int passCount;
+    double passMilis;
+};
+
+/**
+ * Runs solves on a fixed number of threads, in order of priority, then deadline, then submission. With a time slice,
+ * the passes of the solves are interleaved: a thread runs a slice of passes of a solve (on that thread only) and then
+ * moves it behind the solves with the same priority and deadline, so that many small solves make progress fairly
+ * without a thread per solve.
+ */
+class Executor {
+public:
+    /**
+     * Starts the threads of the executor.
+     *
+     * @param nthreads the number of threads
+     * @param slice the number of passes that a solve runs before it yields its thread, or 0 to run each solve to
+     *        completion (with the threads of its own configuration)
+     */
+    explicit Executor(int nthreads, int slice = 0);
+
+    /**
+     * Cancels the solves that have not started, and waits for the started ones to finish.
+     */
+    ~Executor();
+
+    /**
+     * Submits a problem to be solved. The problem must not be destroyed before the solve has finished.
+     *
+     * @param problem the problem
+     * @param configure called with the solver before solving, to set its options (may be empty)
+     * @param callback called when the solve has finished, on the thread of the executor (or on the thread that
+     *        destroys the executor, for a solve that is cancelled then) (may be empty)
+     * @param priority solves with a higher priority run first
+     * @param deadline solves with the same priority run in order of their deadlines (earliest first); the deadline
+     *        is not enforced (see PrSolver::setTimeLimit())
+     * @return the handle of the solve
+     */
+    std::shared_ptr<SolveHandle> submit(Problem& problem, const std::function<void(PrSolver&)>& configure = nullptr,
+                                        const std::function<void(SolveHandle&)>& callback = nullptr,
+                                        int priority = 0,
+                                        std::chrono::steady_clock::time_point deadline =
+                                            std::chrono::steady_clock::time_point::max());
+
+    /**
+     * @return the number of submitted solves that have not started yet
+     */
+    int pending();
+
+private:
+    struct Task {
+        std::shared_ptr<SolveHandle> handle;
+        std::function<void(PrSolver&)> configure;
+        std::function<void(SolveHandle&)> callback;
+        std::unique_ptr<PrSolver> solver; // Solver once the solve has started
+        bool infeasible = false;
+        int priority = 0;
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    };
+
+    void work();
+    void enqueue(Task&& task);
+    void start(Task& task);
+    static void complete(Task& task, bool found);
+    static void finish(Task& task, SolveStatus status);
+
+    std::vector<std::thread> threads;
+    std::deque<Task> queue;
+    std::mutex queueMutex;
+    std::condition_variable available;
+    const int slice;
+    bool stopping;
+};
+}
+
+#endif //RCPSPT_HEURISTIC_EXECUTOR_H
@@ -0,0 +1,362 @@
+/****************************************************************************************[Loader.cc]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+
+#include <algorithm>
+#include <cstdint>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define RCPSPT_IO_URING
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+#include "Loader.h"
+
+using namespace RcpsptHeuristic;
+
+static const int MAX_THREADS = 16;          // Maximum number of threads of the thread pool
+static const size_t MAX_READ = 1u << 30;    // Maximum number of bytes per read
+
+#ifdef RCPSPT_IO_URING
+/**
+ * Submission and completion queues of an io_uring instance, used through the system calls directly (so that liburing
+ * is not needed). Each read is submitted on its own, and at most as many reads are in flight as the ring has entries.
+ */
+struct Loader::Ring {
+    ~Ring() {
+        if (sqes != MAP_FAILED) munmap(sqes, sqesSize);
+        if (cqMap != MAP_FAILED && cqMap != sqMap) munmap(cqMap, cqMapSize);
+        if (sqMap != MAP_FAILED) munmap(sqMap, sqMapSize);
+        if (fd >= 0) close(fd);
+    }
+
+    /**
+     * @return the ring, or nullptr if io_uring is not available
+     */
+    static Ring* create(unsigned entries) {
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        Ring* ring = new Ring();
+        ring->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+        if (ring->fd < 0) {
+            delete ring;
+            return nullptr;
+        }
+
+        ring->sqMapSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        ring->cqMapSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single) ring->sqMapSize = ring->cqMapSize = std::max(ring->sqMapSize, ring->cqMapSize);
+        ring->sqMap = mmap(nullptr, ring->sqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+                           IORING_OFF_SQ_RING);
+        ring->cqMap = single ? ring->sqMap : mmap(nullptr, ring->cqMapSize, PROT_READ | PROT_WRITE,
+                                                  MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+        ring->sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        ring->sqes = (io_uring_sqe*)mmap(nullptr, ring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                         ring->fd, IORING_OFF_SQES);
+        if (ring->sqMap == MAP_FAILED || ring->cqMap == MAP_FAILED || ring->sqes == MAP_FAILED) {
+            delete ring;
+            return nullptr;
+        }
+
+        // Reads need IORING_OP_READ (Linux 5.6, which also introduced the probe)
+        std::vector<io_uring_probe_op> probe(sizeof(io_uring_probe) / sizeof(io_uring_probe_op) + IORING_OP_LAST);
+        io_uring_probe* ops = (io_uring_probe*)probe.data();
+        if (syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_PROBE, ops, IORING_OP_LAST) < 0 ||
+            ops->ops_len <= IORING_OP_READ || !(ops->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED)) {
+            delete ring;
+            return nullptr;
+        }
+
+        char* sq = (char*)ring->sqMap;
+        ring->sqHead = (unsigned*)(sq + params.sq_off.head);
+        ring->sqTail = (unsigned*)(sq + params.sq_off.tail);
+        ring->sqMask = *(unsigned*)(sq + params.sq_off.ring_mask);
+        ring->sqArray = (unsigned*)(sq + params.sq_off.array);
+        char* cq = (char*)ring->cqMap;
+        ring->cqHead = (unsigned*)(cq + params.cq_off.head);
+        ring->cqTail = (unsigned*)(cq + params.cq_off.tail);
+        ring->cqMask = *(unsigned*)(cq + params.cq_off.ring_mask);
+        ring->cqes = (io_uring_cqe*)(cq + params.cq_off.cqes);
+        return ring;
+    }
+
+    /**
+     * Submits a read. If it cannot be submitted, it is taken back from the submission queue, so that no completion
+     * arrives for it.
+     *
+     * @return false if the read could not be submitted
+     */
+    bool read(int file, char* buffer, unsigned length, uint64_t offset, uint64_t userData) {
+        unsigned tail = *sqTail; // Only this thread writes the tail
+        unsigned index = tail & sqMask;
+        io_uring_sqe& sqe = sqes[index];
+        memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_READ;
+        sqe.fd = file;
+        sqe.addr = (uint64_t)(uintptr_t)buffer;
+        sqe.len = length;
+        sqe.off = offset;
+        sqe.user_data = userData;
+        sqArray[index] = index;
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+        if (syscall(__NR_io_uring_enter, fd, 1, 0, 0, nullptr, 0) == 1) return true;
+
+        // Unless the kernel consumed the entry anyway (then its completion arrives as usual)
+        if (__atomic_load_n(sqHead, __ATOMIC_ACQUIRE) != tail) return true;
+        __atomic_store_n(sqTail, tail, __ATOMIC_RELEASE);
+        return false;
+    }
+
+    /**
+     * Waits for the completion of a read.
+     *
+     * @return false if waiting failed
+     */
+    bool wait(uint64_t& userData, int& result) {
+        unsigned head = *cqHead; // Only this thread writes the head
+        while (head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+            if (syscall(__NR_io_uring_enter, fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR)
+                return false;
+        }
+        const io_uring_cqe& cqe = cqes[head & cqMask];
+        userData = cqe.user_data;
+        result = cqe.res;
+        __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    int fd = -1;
+    void* sqMap = MAP_FAILED;
+    void* cqMap = MAP_FAILED;
+    size_t sqMapSize = 0, cqMapSize = 0, sqesSize = 0;
+    io_uring_sqe* sqes = (io_uring_sqe*)MAP_FAILED;
+    unsigned* sqHead = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned sqMask = 0;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned cqMask = 0;
+    io_uring_cqe* cqes = nullptr;
+};
+#else
+struct Loader::Ring {
+    static Ring* create(unsigned) { return nullptr; }
+    bool read(int, char*, unsigned, uint64_t, uint64_t) { return false; }
+    bool wait(uint64_t&, int&) { return false; }
+};
+#endif
+
+Loader::Loader(const std::vector<std::string>& paths, int depth, bool useIoUring)
+    : paths(paths),
+      slots(std::max(depth, 1)),
+      nextIndex(0),
+      nextRead(0),
+      ring(useIoUring ? Ring::create((unsigned)slots.size()) : nullptr),
+      fallingBack(false),
+      stopping(false) {
+    if (ring == nullptr) startThreads();
+    while (ring != nullptr && nextRead < (int)paths.size() && nextRead < (int)slots.size()) submit(nextRead++);
+}
+
+Loader::~Loader() {
+    if (ring != nullptr) {
+        // Wait for the reads in flight, which write into the buffers of the slots
+        int inflight = 0;
+        for (int index = nextIndex; index < nextRead; index++) inflight += !slot(index).ready;
+        uint64_t userData;
+        int result;
+        while (inflight > 0 && ring->wait(userData, result)) {
+            Slot& s = slot((int)userData);
+            if (s.fd >= 0) close(s.fd);
+            s.fd = -1;
+            inflight--;
+        }
+        delete ring;
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    readable.notify_all();
+    for (std::thread& thread : threads) thread.join();
+}
+
+void Loader::startThreads() {
+    int nthreads = std::min({(int)slots.size(), (int)paths.size() - nextIndex, MAX_THREADS});
+    for (int i = 0; i < nthreads; i++) threads.emplace_back(&Loader::read, this);
+}
+
+void Loader::fallBack(int index) {
+    Slot& s = slot(index);
+    close(s.fd);
+    s.fd = -1;
+    retries.push_back(index);
+    if (fallingBack) return; // The reads in flight are being waited for
+
+    // Wait for the reads in flight, which write into the buffers of the slots (short reads are read again as well)
+    fallingBack = true;
+    uint64_t userData;
+    int result;
+    for (int i = nextIndex; i < nextRead; i++) {
+        while (!slot(i).ready && slot(i).fd >= 0) {
+            if (ring->wait(userData, result)) complete((int)userData, result);
+            else complete(i, -EIO); // Only if the ring itself is broken
+        }
+    }
+    delete ring;
+    ring = nullptr;
+    startThreads();
+}
+
+bool Loader::open(int index) {
+    Slot& s = slot(index);
+    s.ok = false;
+    s.offset = 0;
+    s.size = 0;
+    s.fd = ::open(paths[index].c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat status;
+    if (s.fd >= 0 && fstat(s.fd, &status) == 0 && S_ISREG(status.st_mode)) {
+        s.size = (size_t)status.st_size;
+        s.data.resize(s.size);
+        return true;
+    }
+    if (s.fd >= 0) close(s.fd);
+    s.fd = -1;
+    s.data.clear();
+    return false;
+}
+
+void Loader::submit(int index) {
+    Slot& s = slot(index);
+    if (!open(index)) s.ready = true;
+    else if (s.size == 0) complete(index, 0);
+    else {
+        unsigned length = (unsigned)std::min(s.size - s.offset, MAX_READ);
+        if (!ring->read(s.fd, s.data.data() + s.offset, length, s.offset, (uint64_t)index)) fallBack(index);
+    }
+}
+
+void Loader::complete(int index, int result) {
+    Slot& s = slot(index);
+    if (result > 0) {
+        s.offset += (size_t)result;
+        if (s.offset < s.size) { // Short read, read the rest
+            unsigned length = (unsigned)std::min(s.size - s.offset, MAX_READ);
+            if (fallingBack || !ring->read(s.fd, s.data.data() + s.offset, length, s.offset, (uint64_t)index))
+                fallBack(index);
+            return;
+        }
+    }
+    s.ok = result >= 0;
+    s.data.resize(s.offset); // The file may have shrunk since it was opened
+    s.ready = true;
+    close(s.fd);
+    s.fd = -1;
+}
+
+void Loader::read() {
+    while (true) {
+        int index;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            readable.wait(lock, [this]() {
+                return stopping || !retries.empty() ||
+                       (nextRead < (int)paths.size() && nextRead < nextIndex + (int)slots.size());
+            });
+            if (stopping) return;
+            if (!retries.empty()) {
+                index = retries.back();
+                retries.pop_back();
+            }
+            else index = nextRead++;
+        }
+
+        // The slot is not touched by other threads until it is ready
+        bool ok = open(index);
+        Slot& s = slot(index);
+        while (ok && s.offset < s.size) {
+            ssize_t n = pread(s.fd, s.data.data() + s.offset, std::min(s.size - s.offset, MAX_READ), (off_t)s.offset);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                ok = n == 0;
+                break;
+            }
+            s.offset += (size_t)n;
+        }
+        if (s.fd >= 0) {
+            s.data.resize(s.offset);
+            close(s.fd);
+            s.fd = -1;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            s.ok = ok;
+            s.ready = true;
+        }
+        loaded.notify_all();
+    }
+}
+
+bool Loader::next(LoadedFile& file) {
+    if (nextIndex >= (int)paths.size()) return false;
+    Slot& s = slot(nextIndex);
+    uint64_t userData;
+    int result;
+    while (ring != nullptr && !s.ready) {
+        if (ring->wait(userData, result)) complete((int)userData, result);
+        else complete(nextIndex, -EIO); // Only if the ring itself is broken
+    }
+    if (ring == nullptr) { // The thread pool reads the files (possibly since a submission to the ring failed)
+        std::unique_lock<std::mutex> lock(mutex);
+        loaded.wait(lock, [&s]() { return s.ready; });
+    }
+
+    file.path = paths[nextIndex];
+    file.ok = s.ok;
+    std::swap(file.data, s.data);
+    if (ring != nullptr) {
+        s.ready = false;
+        nextIndex++;
+        while (ring != nullptr && nextRead < (int)paths.size() && nextRead < nextIndex + (int)slots.size())
+            submit(nextRead++);
+    }
+    else {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            s.ready = false;
+            nextIndex++;
+        }
+        readable.notify_one();
+    }
+    return true;
+}
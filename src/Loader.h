@@ -0,0 +1,116 @@
+/*****************************************************************************************[Loader.h]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+
+#ifndef RCPSPT_HEURISTIC_LOADER_H
+#define RCPSPT_HEURISTIC_LOADER_H
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace RcpsptHeuristic {
+
+/**
+ * Contents of a file that was read by a Loader.
+ */
+struct LoadedFile {
+    std::string path;
+    std::vector<char> data; // Contents of the file
+    bool ok = false;        // Whether the file could be read
+};
+
+/**
+ * Reads files ahead of their use, with many reads in flight at once, so that slow storage or cold caches keep their
+ * queues full. The files are returned in the given order. On Linux the reads are issued through io_uring; if it is
+ * not available (or disabled), a pool of threads reads the files with blocking reads. If a read cannot be submitted
+ * to io_uring, the reads in flight are completed and the thread pool reads the remaining files.
+ */
+class Loader {
+public:
+    /**
+     * Starts reading the first files.
+     *
+     * @param paths the files to read, in the order in which they are returned
+     * @param depth the maximum number of files that are read ahead (at least 1)
+     * @param useIoUring whether io_uring may be used
+     */
+    Loader(const std::vector<std::string>& paths, int depth, bool useIoUring = true);
+
+    /**
+     * Stops reading, after waiting for the reads in flight.
+     */
+    ~Loader();
+
+    /**
+     * Waits for the next file to be read. The buffer of the previous contents of file is reused for a later file.
+     *
+     * @param file the file, to which the path and contents are written
+     * @return false if all files were returned, true otherwise
+     */
+    bool next(LoadedFile& file);
+
+    /**
+     * @return whether the reads are issued through io_uring
+     */
+    bool usesIoUring() const { return ring != nullptr; }
+
+private:
+    struct Slot {
+        int fd = -1;
+        size_t size = 0;   // Size of the file
+        size_t offset = 0; // Number of bytes read so far
+        std::vector<char> data;
+        bool ready = false;
+        bool ok = false;
+    };
+    struct Ring;
+
+    Slot& slot(int index) { return slots[index % slots.size()]; }
+    bool open(int index);
+    void submit(int index);
+    void complete(int index, int result);
+    void fallBack(int index);
+    void startThreads();
+    void read();
+
+    const std::vector<std::string> paths;
+    std::vector<Slot> slots; // Files that are read ahead, by index modulo the depth
+    int nextIndex;           // Index of the next file to return
+    int nextRead;            // Index of the next file to start reading
+
+    Ring* ring;       // io_uring, or nullptr if the thread pool is used
+    bool fallingBack; // Whether the reads in flight on the ring are completed before the thread pool takes over
+
+    // Thread pool
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable readable; // Signalled when a slot becomes free or the loader stops
+    std::condition_variable loaded;   // Signalled when a file was read
+    std::vector<int> retries;         // Files to read from the start, since their reads could not be submitted
+    bool stopping;
+};
+}
+
+#endif //RCPSPT_HEURISTIC_LOADER_H
@@ -23,52 +23,158 @@ SOFTWARE.
 #include <iostream>
 #include <fstream>
 #include <ctime>
+#include <chrono>
 #include <filesystem>
 #include <algorithm>
+#include <sstream>
+#include <unordered_map>
 
 #include "Solver.h"
 #include "Parser.h"
 #include "Problem.h"
+#include "SolutionStore.h"
+#include "Benchmark.h"
+#include "MultiProject.h"
+#include "Daemon.h"
+#include "Loader.h"
+#include "ResultFile.h"
 
 #define FILE_EXTENSION ".smt"
 
 using namespace RcpsptHeuristic;
 
 bool checkValid(const Problem& problem, const int* solution) {
-    // Initialize remaining resource availabilities
-    int** available = new int*[problem.nresources];
-    for (int k = 0; k < problem.nresources; k++) {
-        available[k] = new int[problem.horizon];
-        for (int t = 0; t < problem.horizon; t++)
-            available[k][t] = problem.capacities[k][t];
+    std::string error;
+    bool valid = problem.validate(solution, &error);
+    if (!valid) std::cout << error << std::endl;
+    return valid;
+}
+
+/**
+ * Solves the problem, using the solution store (if given) to skip instances that were already solved to optimality,
+ * and to warm start the solver otherwise. Improved solutions are recorded in the store.
+ *
+ * @param problem the problem to solve
+ * @param solver the solver to use
+ * @param store the solution store to use, or nullptr
+ * @param out vector to which end times for all activities will be written
+ * @param infeasible indicates whether the preprocessing steps found the instance to be infeasible
+ * @return true if a solution was found, false otherwise
+ */
+bool solveInstance(Problem& problem, PrSolver& solver, SolutionStore* store, int* out, bool* infeasible) {
+    if (store == nullptr) return solver.solve(out, infeasible);
+
+    uint64_t fingerprint = problem.fingerprint();
+    StoredSolution stored;
+    bool known = store->lookup(fingerprint, stored) && (int)stored.schedule.size() == problem.njobs &&
+                 checkValid(problem, stored.schedule.data());
+    if (known && stored.makespan <= stored.lowerBound) { // Proven optimal, no need to solve again
+        for (int i = 0; i < problem.njobs; i++) out[i] = stored.schedule[i];
+        *infeasible = false;
+        return true;
     }
+    if (known) solver.setIncumbent(stored.schedule.data());
 
-    for (int job = 0; job < problem.njobs; job++) {
-        // Precedence constraints
-        for (int predecessor: problem.predecessors[job]) {
-            int start = solution[job] - problem.durations[job];
-            if (start < solution[predecessor]) {
-                std::cout << "invalid precedence!" << std::endl;
-                return false;
-            }
-        }
+    bool found = solver.solve(out, infeasible);
+    if (found)
+        store->record(fingerprint, {out[problem.njobs - 1], solver.getLowerBound(), solver.getConfig(),
+                                    std::vector<int>(out, out + problem.njobs)});
+    return found;
+}
+
+/**
+ * Writes the time windows and upper bound that were found by the solver to the given output file, so that they can be
+ * used to reduce domain sizes in external (CP/MIP) models.
+ * Format: a line "upper_bound [makespan]", followed by a line "[job] [earliest start] [latest finish] [bitmap]" for
+ * each job, where the bitmap contains a '1' for each start time in the window at which the job is resource-feasible.
+ *
+ * @param problem the problem that was solved
+ * @param solver the solver that was used to solve the problem
+ * @param output file to write the time windows to
+ */
+void writeTimeWindows(const Problem& problem, const PrSolver& solver, ofstream& output) {
+    TimeWindow* windows = new TimeWindow[problem.njobs];
+    if (!solver.getTimeWindows(windows)) {
+        delete[] windows;
+        return;
     }
 
+    if (solver.getUpperBound() <= problem.horizon) output << "upper_bound " << solver.getUpperBound() << std::endl;
+    else output << "upper_bound " << problem.horizon << std::endl;
     for (int job = 0; job < problem.njobs; job++) {
-        // Resource constraints
-        for (int k = 0; k < problem.nresources; k++) {
-            for (int t = 0; t < problem.durations[job]; t++) {
-                int curr = solution[job] - problem.durations[job] + t;
-                available[k][curr] -= problem.requests[job][k][t];
-                if (available[k][curr] < 0) {
-                    std::cout << "resource demand exceeds availability at t=" << curr << '!' << std::endl;
-                    return false;
-                }
-            }
-        }
+        output << job << ' ' << windows[job].earliestStart << ' ' << windows[job].latestFinish << ' ';
+        for (bool feasible : windows[job].feasibleStarts) output << (feasible ? '1' : '0');
+        output << std::endl;
+    }
+
+    delete[] windows;
+}
+
+/**
+ * Solver settings from the command line options.
+ */
+struct SolverOptions {
+    int nthreads = 1;                      // Number of threads that run passes
+    Layout layout = Layout::ResourceMajor; // Memory layout of the remaining resource availabilities
+    bool decompose = false;                // Whether to solve independent parts of the problem separately
+    bool contract = false;                 // Whether to schedule chains of activities as composite activities
+    int window = 0;                        // Window of the rolling-horizon mode, or 0
+    int lookahead = 0;                     // Look-ahead of the rolling-horizon mode
+    unsigned seed = 0;                     // Seed of the random number generators, or 0
+    std::string checkpoint;                // Checkpoint file, or empty
+    int checkpointInterval = 100;          // Number of passes between checkpoints
+    int elite = 0;                         // Size of the elite pool, or 0
+    bool relink = false;                   // Whether to relink the schedules of the elite pool after the passes
+
+    void apply(PrSolver& solver) const {
+        solver.setThreads(nthreads);
+        solver.setLayout(layout);
+        solver.setDecompose(decompose);
+        solver.setContractChains(contract);
+        solver.setRollingHorizon(window, lookahead);
+        solver.setSeed(seed);
+        solver.setCheckpoint(checkpoint, checkpointInterval);
+        solver.setElitePool(elite);
+        solver.setPathRelinking(relink);
+    }
+};
+
+/**
+ * Reference values for a problem instance, used to compute gaps in batch mode.
+ */
+struct Reference {
+    int bestKnown;  // Best known makespan
+    int lowerBound; // Best known lower bound on the makespan
+};
+
+/**
+ * Loads reference values from a file containing a line "[instance name] [best known makespan] [lower bound]" for each
+ * instance, where the instance name is the file name without extension. The lower bound is optional, and lines
+ * starting with '#' are ignored.
+ *
+ * @param path the file to read
+ * @return the reference values per instance name
+ */
+std::unordered_map<std::string, Reference> loadReferences(const std::string& path) {
+    std::unordered_map<std::string, Reference> references;
+    std::ifstream input(path);
+    if (!input) {
+        std::cerr << "Can't open reference file: " << path << std::endl;
+        exit(1);
     }
 
-    return true;
+    std::string line;
+    while (std::getline(input, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream tokens(line);
+        std::string name;
+        Reference reference{-1, -1};
+        tokens >> name >> reference.bestKnown;
+        if (!tokens) continue;
+        if (!(tokens >> reference.lowerBound)) reference.lowerBound = -1;
+        references[name] = reference;
+    }
+    return references;
 }
 
 /**
@@ -76,8 +182,18 @@ bool checkValid(const Problem& problem, const int* solution) {
  *
  * @param directory the directory path to recursively search under
  * @param output file to writes results to (file path, makespan that was found, cpu time)
+ * @param store the solution store to use, or nullptr
+ * @param references reference values per instance name, used to stop at and compute gaps to the best known makespan
+ * @param options the solver settings
+ * @param profile file to write the anytime profile (trajectory of incumbent improvements) of each instance to, or nullptr
+ * @param results binary result file to write the schedule of each instance to, or nullptr
+ * @param prefetch the number of instance files that are read ahead
+ * @param ioUring whether the instance files may be read through io_uring
  */
-void findInstancesAndSolveAll(const std::string& directory, ofstream& output) {
+void findInstancesAndSolveAll(const std::string& directory, ofstream& output, SolutionStore* store,
+                              const std::unordered_map<std::string, Reference>& references,
+                              const SolverOptions& options, ofstream* profile, ResultWriter* results, int prefetch,
+                              bool ioUring) {
     std::vector<string> paths;
     for (const auto& f : std::filesystem::recursive_directory_iterator(directory)) {
         if (!std::filesystem::is_directory(f) && f.path().extension() == FILE_EXTENSION)
@@ -85,21 +201,34 @@ void findInstancesAndSolveAll(const std::string& directory, ofstream& output) {
     }
     std::sort(paths.begin(), paths.end());
 
+    // Aggregate statistics over the instances that have reference values
+    int nreferenced = 0, nsolved = 0, noptimal = 0, nreached = 0;
+    double totalGap = 0.0, totalTimeToTarget = 0.0;
+
     std::cout << "Solving " << paths.size() << " problems..." << std::endl;
+    int progressStep = std::max((int)paths.size() / 100, 1);
+    Loader loader(paths, prefetch, ioUring);
+    LoadedFile file;
     for (int i = 0; i < (int)paths.size(); i++) {
-        std::ifstream inpFile(paths[i]);
-        if (!inpFile) {
+        loader.next(file);
+        if (!file.ok) {
             std::cerr << "Can't open input file: " << paths[i] << std::endl;
             exit(1);
         }
         std::clock_t start_total = std::clock();
-        Problem problem = Parser::parseProblemInstance(inpFile);
-        inpFile.close();
+        Problem problem = Parser::parseProblemInstance(file.data.data(), file.data.size());
 
         int* result = new int[problem.njobs];
         bool infeasible = false;
         std::clock_t start = std::clock();
-        bool found = PrSolver(problem).solve(result, &infeasible);
+        PrSolver solver(problem);
+        options.apply(solver);
+        std::string name = std::filesystem::path(paths[i]).stem().string();
+        auto reference = references.find(name);
+        if (reference != references.end()) solver.setTarget(reference->second.bestKnown);
+        std::chrono::steady_clock::time_point solveStart = std::chrono::steady_clock::now();
+        bool found = solveInstance(problem, solver, store, result, &infeasible);
+        std::chrono::duration<double, std::milli> solveTime = std::chrono::steady_clock::now() - solveStart;
         std::clock_t end = std::clock();
 
         long milis = ((end - start) * 1000) / CLOCKS_PER_SEC; // TODO: write to file in proper format
@@ -109,25 +238,248 @@ void findInstancesAndSolveAll(const std::string& directory, ofstream& output) {
         else output << "nosolution" << std::endl;
         output << "cpu_milis " << milis << std::endl;
         output << "total_milis " << ((std::clock() - start_total) * 1000) / CLOCKS_PER_SEC << std::endl;
+        if (reference != references.end()) {
+            const Reference& ref = reference->second;
+            nreferenced++;
+            output << "reference " << ref.bestKnown << std::endl;
+            if (found) {
+                int makespan = result[problem.njobs - 1];
+                double gap = 100.0 * (makespan - ref.bestKnown) / std::max(ref.bestKnown, 1);
+                nsolved++;
+                totalGap += gap;
+                output << "gap_percent " << gap << std::endl;
+                if (makespan <= std::max(ref.lowerBound, solver.getLowerBound())) noptimal++;
+                if (makespan <= ref.bestKnown) {
+                    // Wall-clock time of the first incumbent that reached the target (or of the whole solve, if the
+                    // schedule came from the store)
+                    double timeToTarget = solveTime.count();
+                    for (const Improvement& improvement : solver.getTrajectory()) {
+                        if (improvement.makespan > ref.bestKnown) continue;
+                        timeToTarget = improvement.milis;
+                        break;
+                    }
+                    nreached++;
+                    totalTimeToTarget += timeToTarget;
+                    output << "time_to_target_milis " << timeToTarget << std::endl;
+                }
+            }
+        }
         output << std::endl;
+        if (profile != nullptr) Benchmark::writeTrajectory({name, solver.getConfig(), solver.getTrajectory()}, *profile);
+        if (results != nullptr) {
+            ResultStatus status = found ? ResultStatus::Found : infeasible ? ResultStatus::Infeasible
+                                                                           : ResultStatus::NoSolution;
+            results->add(paths[i], status, milis, found ? result : nullptr, problem.njobs);
+        }
         if (found && !checkValid(problem, result)) std::cout << "Invalid solution: " << paths[i] << std::endl;
 
         delete[] result;
-        if (i % (paths.size()/100) == 0) std::cout << i / (paths.size()/100) << '%' << std::endl;
+        if (i % progressStep == 0) std::cout << (i * 100) / (int)paths.size() << '%' << std::endl;
+    }
+
+    if (nreferenced > 0) {
+        std::stringstream summary;
+        summary << "summary" << std::endl;
+        summary << "instances_with_reference " << nreferenced << std::endl;
+        summary << "solved " << nsolved << std::endl;
+        summary << "mean_gap_percent " << (nsolved > 0 ? totalGap / nsolved : 0.0) << std::endl;
+        summary << "optimal " << noptimal << std::endl;
+        summary << "target_reached " << nreached << std::endl;
+        summary << "mean_time_to_target_milis " << (nreached > 0 ? totalTimeToTarget / nreached : 0.0) << std::endl;
+        output << summary.str();
+        std::cout << std::endl << summary.str();
+    }
+}
+
+/**
+ * Combines multiple projects into one problem with a shared resource pool, solves it, and writes the completion time
+ * and tardiness of each project to standard output.
+ *
+ * @param specs a "[path to file of problem instance][:priority[:due date]]" for each project
+ * @param options the solver settings
+ */
+void solveMultiProject(const std::vector<char*>& specs, const SolverOptions& options) {
+    std::vector<Problem*> parsed;
+    std::vector<const Problem*> projects;
+    std::vector<double> priorities;
+    std::vector<int> dueDates;
+    for (char* spec : specs) {
+        std::string path = spec, priority = "1", dueDate = "-1";
+        size_t colon = path.find(':');
+        if (colon != std::string::npos) {
+            priority = path.substr(colon + 1);
+            path = path.substr(0, colon);
+            colon = priority.find(':');
+            if (colon != std::string::npos) {
+                dueDate = priority.substr(colon + 1);
+                priority = priority.substr(0, colon);
+            }
+        }
+
+        std::ifstream inpFile(path);
+        if (!inpFile) {
+            std::cerr << "Can't open input file: " << path << std::endl;
+            exit(1);
+        }
+        parsed.push_back(new Problem(Parser::parseProblemInstance(inpFile)));
+        if (parsed.back()->nresources != parsed.front()->nresources) {
+            std::cerr << "All projects should have the same number of resources: " << path << std::endl;
+            exit(1);
+        }
+        projects.push_back(parsed.back());
+        priorities.push_back(std::stod(priority));
+        dueDates.push_back(std::stoi(dueDate));
+        std::cout << "Project " << projects.size() - 1 << ": " << path << std::endl;
     }
+
+    MultiProject multi(projects, priorities, dueDates);
+    Problem& problem = *multi.problem;
+    int* result = new int[problem.njobs];
+    bool infeasible = false;
+    std::clock_t start = std::clock();
+    PrSolver solver(problem);
+    options.apply(solver);
+    solver.setPriorityWeights(multi.weights);
+    bool found = solver.solve(result, &infeasible);
+    std::clock_t end = std::clock();
+
+    std::cout << std::endl;
+    if (found) {
+        std::cout << "Makespan: " << result[problem.njobs - 1] << std::endl;
+        for (int p = 0; p < (int)multi.projects.size(); p++) {
+            const ProjectInfo& info = multi.projects[p];
+            int completion = result[info.endJob];
+            std::cout << "Project " << p << ": completion " << completion;
+            if (info.dueDate >= 0) std::cout << ", due " << info.dueDate << ", tardiness " << std::max(completion - info.dueDate, 0);
+            std::cout << std::endl;
+        }
+        std::cout << std::endl;
+    }
+    else if (infeasible) std::cout << "Preprocessing found instance to be infeasible" << std::endl;
+    else std::cout << "Found no feasible solution." << std::endl;
+    std::cout << "Took " << ((end - start) * 1000) / CLOCKS_PER_SEC << " ms" << std::endl;
+    if (found) std::cout << "Valid? " << checkValid(problem, result);
+
+    delete[] result;
+    for (Problem* project : parsed) delete project;
 }
 
 int main(int argc, char** argv) {
-    if (argc < 2) {
+    // Separate options from positional arguments
+    std::vector<char*> args;
+    char* windowsPath = nullptr;
+    char* storePath = nullptr;
+    char* referencePath = nullptr;
+    char* profilePath = nullptr;
+    char* resultsPath = nullptr;
+    SolverOptions options;
+    std::vector<char*> comparePaths;
+    std::vector<char*> projectSpecs;
+    int daemonPort = 0;
+    int prefetch = 32;
+    bool ioUring = true;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--compare") { // All remaining arguments are profile files
+            comparePaths.assign(argv + i + 1, argv + argc);
+            break;
+        }
+        if (arg == "--multi") { // All remaining arguments are projects
+            projectSpecs.assign(argv + i + 1, argv + argc);
+            break;
+        }
+        if (arg == "--windows" && i + 1 < argc) windowsPath = argv[++i];
+        else if (arg == "--store" && i + 1 < argc) storePath = argv[++i];
+        else if (arg == "--reference" && i + 1 < argc) referencePath = argv[++i];
+        else if (arg == "--profile" && i + 1 < argc) profilePath = argv[++i];
+        else if (arg == "--results" && i + 1 < argc) resultsPath = argv[++i];
+        else if (arg == "--prefetch" && i + 1 < argc) prefetch = std::max(std::stoi(argv[++i]), 1);
+        else if (arg == "--no-io-uring") ioUring = false;
+        else if (arg == "--daemon" && i + 1 < argc) daemonPort = std::stoi(argv[++i]);
+        else if (arg == "--threads" && i + 1 < argc) options.nthreads = std::max(std::stoi(argv[++i]), 1);
+        else if (arg == "--time-major") options.layout = Layout::TimeMajor;
+        else if (arg == "--decompose") options.decompose = true;
+        else if (arg == "--contract") options.contract = true;
+        else if (arg == "--seed" && i + 1 < argc) options.seed = (unsigned)std::stoul(argv[++i]);
+        else if (arg == "--relink") options.relink = true;
+        else if (arg == "--elite" && i + 1 < argc) options.elite = std::max(std::stoi(argv[++i]), 0);
+        else if (arg == "--checkpoint" && i + 1 < argc) options.checkpoint = argv[++i];
+        else if (arg == "--checkpoint-interval" && i + 1 < argc)
+            options.checkpointInterval = std::max(std::stoi(argv[++i]), 1);
+        else if (arg == "--rolling" && i + 1 < argc) { // Window and optional look-ahead, as [window][:look-ahead]
+            std::string spec = argv[++i];
+            size_t colon = spec.find(':');
+            options.window = std::max(std::stoi(spec.substr(0, colon)), 0);
+            options.lookahead = colon != std::string::npos ? std::max(std::stoi(spec.substr(colon + 1)), 0) : options.window;
+        }
+        else args.push_back(argv[i]);
+    }
+    SolutionStore* store = storePath != nullptr ? new SolutionStore(storePath) : nullptr;
+
+    if (!comparePaths.empty()) { // Compare anytime profiles of earlier batch runs
+        std::vector<std::string> labels;
+        std::vector<std::vector<Trajectory>> runs;
+        for (char* path : comparePaths) {
+            std::ifstream profileFile(path);
+            if (!profileFile) {
+                std::cerr << "Can't open profile file: " << path << std::endl;
+                exit(1);
+            }
+            labels.push_back(std::filesystem::path(path).stem().string());
+            runs.push_back(Benchmark::readTrajectories(profileFile));
+        }
+        Benchmark::compare(labels, runs, std::cout);
+        return 0;
+    }
+
+    if (!projectSpecs.empty()) {
+        solveMultiProject(projectSpecs, options);
+        return 0;
+    }
+
+    if (daemonPort > 0) { // Serve solves and metrics, interleaving the passes of concurrent solves
+        Daemon daemon(daemonPort, options.nthreads, 100);
+        std::cout << "Listening on 127.0.0.1:" << daemonPort << std::endl;
+        if (!daemon.run()) {
+            std::cerr << "Can't listen on port " << daemonPort << std::endl;
+            exit(1);
+        }
+        return 0;
+    }
+
+    if (args.empty()) {
         std::cerr << "Missing first argument(s), use one of the following options: " << std::endl;
         std::cout << " - [path to file of problem instance]. Results are written to standard output." << std::endl;
         std::cout << " - [path to directory] [output file]. Recursively problem instance files (from the directory) are found and run, and all results are written to the output file." << std::endl;
+        std::cout << " - --compare [profile file]... Compares the anytime profiles of earlier runs with --profile, and writes performance profiles and time-to-target distributions to standard output." << std::endl;
+        std::cout << " - --multi [path to file of problem instance][:priority[:due date]]... Solves the projects together, sharing the resource capacities of the first project. Results are written to standard output." << std::endl;
+        std::cout << " - --daemon [port]. Serves GET /solve?path=[path to file of problem instance]&config=[settings] and GET /metrics (Prometheus text format) over HTTP on 127.0.0.1, solving on the threads of --threads." << std::endl;
+        std::cout << "Additional options:" << std::endl;
+        std::cout << " --threads [n]. Runs the passes of the solver on n threads." << std::endl;
+        std::cout << " --decompose. Solves groups of independent subnetworks (that share no resources) separately, in parallel." << std::endl;
+        std::cout << " --contract. Schedules chains of activities (that are linked only to each other) as single composite activities." << std::endl;
+        std::cout << " --rolling [window][:look-ahead]. Schedules the activities window by window (of the given number of time steps), looking ahead the given number of time steps (default: the window)." << std::endl;
+        std::cout << " --time-major. Stores the remaining resource availabilities time-major, comparing all resources of a time step at once." << std::endl;
+        std::cout << " --seed [n]. Seeds the random number generators, so that single-threaded runs are reproducible." << std::endl;
+        std::cout << " --elite [k]. Keeps the k best schedules that are distinct in activity order (for a single problem instance, their makespans are written to standard output)." << std::endl;
+        std::cout << " --relink. After the passes, relinks pairs of schedules of the elite pool (of 8 schedules unless set by --elite) within the remaining time." << std::endl;
+        std::cout << " --checkpoint [file]. Resumes from the checkpoint file if it exists, and writes it during the passes (which run on one thread)." << std::endl;
+        std::cout << " --checkpoint-interval [n]. Writes a checkpoint every n passes (default 100)." << std::endl;
+        std::cout << " --store [file]. Keeps the best known solution per instance in the file, and uses it to warm start or skip solving." << std::endl;
+        std::cout << "Additional options for a directory of problem instances:" << std::endl;
+        std::cout << " --reference [file]. Reads best known makespans and lower bounds (lines of \"[instance name] [makespan] [lower bound]\"), stops each instance at its best known makespan and reports gaps." << std::endl;
+        std::cout << " --profile [file]. Writes the anytime profile (time and makespan of each improvement) of each instance to the file." << std::endl;
+        std::cout << " --results [file]. Writes the schedule of each instance to a binary result file (see ResultFile.h), which can be read with rcpspt_results_open() of the shared library." << std::endl;
+        std::cout << " --prefetch [n]. Reads up to n instance files ahead of the solver, concurrently (default 32)." << std::endl;
+        std::cout << " --no-io-uring. Reads the instance files ahead on a pool of threads instead of through io_uring." << std::endl;
+        std::cout << "Additional options for a single problem instance:" << std::endl;
+        std::cout << " --windows [output file]. Writes the time windows of all jobs and the upper bound to the output file." << std::endl;
         exit(1);
     }
 
-    if (argc <= 2) { // Only an input file
-        std::cout << "File: " << argv[1] << std::endl << std::endl;
-        std::ifstream inpFile(argv[1]);
+    if (args.size() < 2) { // Only an input file
+        std::cout << "File: " << args[0] << std::endl << std::endl;
+        std::ifstream inpFile(args[0]);
         if (!inpFile) {
             std::cerr << "Can't open input file." << std::endl;
             exit(1);
@@ -138,30 +490,70 @@ int main(int argc, char** argv) {
         int *result = new int[problem.njobs];
         bool infeasible = false;
         std::clock_t start = std::clock();
-        bool found = PrSolver(problem).solve(result, &infeasible);
+        PrSolver solver(problem);
+        options.apply(solver);
+        bool found = solveInstance(problem, solver, store, result, &infeasible);
         std::clock_t end = std::clock();
 
+        if (windowsPath != nullptr) {
+            std::ofstream windowsFile(windowsPath);
+            if (!windowsFile) {
+                std::cerr << "Can't create or open time windows file." << std::endl;
+                exit(1);
+            }
+            writeTimeWindows(problem, solver, windowsFile);
+            windowsFile.close();
+        }
+
         long milis = ((end - start) * 1000) / CLOCKS_PER_SEC;
         if (found) std::cout << "Makespan: " << result[problem.njobs - 1] << std::endl << std::endl;
         else if (infeasible) std::cout << "Preprocessing found instance to be infeasible" << std::endl;
         else std::cout << "Found no feasible solution." << std::endl;
+        if (options.elite > 0) {
+            std::cout << "Elite makespans:";
+            for (const EliteSchedule& member : solver.getElite()) std::cout << " " << member.makespan;
+            std::cout << std::endl << std::endl;
+        }
         std::cout << "Took " << milis << " ms" << std::endl;
         if (found) std::cout << "Valid? " << checkValid(problem, result);
 
         delete[] result;
     }
     else { // Input data directory and output file
-        std::cout << "Test data directory: " << argv[1] << std::endl;
-        std::ofstream outFile(argv[2]);
+        std::cout << "Test data directory: " << args[0] << std::endl;
+        std::ofstream outFile(args[1]);
         if (!outFile) {
             std::cerr << "Can't create or open output file." << std::endl;
             exit(1);
         }
-        findInstancesAndSolveAll(argv[1], outFile);
+        std::unordered_map<std::string, Reference> references;
+        if (referencePath != nullptr) references = loadReferences(referencePath);
+        std::ofstream* profileFile = nullptr;
+        if (profilePath != nullptr) {
+            profileFile = new std::ofstream(profilePath);
+            if (!*profileFile) {
+                std::cerr << "Can't create or open profile file." << std::endl;
+                exit(1);
+            }
+        }
+        ResultWriter* resultsFile = nullptr;
+        if (resultsPath != nullptr) {
+            resultsFile = new ResultWriter(resultsPath);
+            if (!resultsFile->isOpen()) {
+                std::cerr << "Can't create or open results file." << std::endl;
+                exit(1);
+            }
+        }
+        findInstancesAndSolveAll(args[0], outFile, store, references, options, profileFile, resultsFile, prefetch,
+                                 ioUring);
+        delete profileFile;
+        if (resultsFile != nullptr && !resultsFile->close()) std::cerr << "Can't write results file." << std::endl;
+        delete resultsFile;
         outFile.close();
         std::cout << std::endl;
-        std::cout << "Results written to output file: " << argv[2] << std::endl;
+        std::cout << "Results written to output file: " << args[1] << std::endl;
     }
 
+    delete store;
     return 0;
 }
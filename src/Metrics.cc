@@ -0,0 +1,206 @@
+/**************************************************************************************[Metrics.cc]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <unistd.h>
+
+#include "Metrics.h"
+
+using namespace RcpsptHeuristic;
+
+const double Metrics::bucketBounds[NBUCKETS] = {0.1, 0.5, 1, 5, 10, 50, 100, 500, 1000, 5000};
+
+namespace {
+
+const int NCOUNTERS = (int)Counter::Count;
+const int NPHASES = (int)Phase::Count;
+
+/**
+ * Metrics recorded by a single thread. Only the owning thread writes, so relaxed operations suffice.
+ */
+struct Shard {
+    std::atomic<uint64_t> counters[NCOUNTERS] = {};
+    std::atomic<uint64_t> buckets[NPHASES][Metrics::NBUCKETS + 1] = {}; // Observations per bucket (not cumulative)
+    std::atomic<uint64_t> micros[NPHASES] = {};                         // Sum of the observations in microseconds
+};
+
+void increment(std::atomic<uint64_t>& value, uint64_t n) {
+    value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+/**
+ * Adds the metrics of a shard to another shard.
+ */
+void accumulate(Shard& total, const Shard& shard) {
+    for (int i = 0; i < NCOUNTERS; i++) increment(total.counters[i], shard.counters[i].load(std::memory_order_relaxed));
+    for (int p = 0; p < NPHASES; p++) {
+        for (int b = 0; b <= Metrics::NBUCKETS; b++)
+            increment(total.buckets[p][b], shard.buckets[p][b].load(std::memory_order_relaxed));
+        increment(total.micros[p], shard.micros[p].load(std::memory_order_relaxed));
+    }
+}
+
+/**
+ * Shards of all live threads that recorded metrics. When a thread exits, its shard is folded into the retired totals
+ * (so that the totals never decrease) and released, since the daemon starts a thread per connection.
+ */
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Shard>> shards;
+    Shard retired; // Totals of the shards of exited threads (only written under the mutex)
+    const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+/**
+ * Registers the shard of a thread, and retires it when the thread exits.
+ */
+struct ShardOwner {
+    Shard* shard;
+
+    ShardOwner() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.shards.emplace_back(new Shard());
+        shard = r.shards.back().get();
+    }
+
+    ~ShardOwner() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        accumulate(r.retired, *shard);
+        for (size_t i = 0; i < r.shards.size(); i++) {
+            if (r.shards[i].get() != shard) continue;
+            r.shards[i] = std::move(r.shards.back());
+            r.shards.pop_back();
+            break;
+        }
+    }
+};
+
+Shard& localShard() {
+    thread_local ShardOwner owner;
+    return *owner.shard;
+}
+
+const char* counterNames[NCOUNTERS] = {
+    "rcpspt_requests_total{status=\"found\"}",
+    "rcpspt_requests_total{status=\"infeasible\"}",
+    "rcpspt_requests_total{status=\"no_solution\"}",
+    "rcpspt_requests_total{status=\"cancelled\"}",
+    "rcpspt_requests_total{status=\"failed\"}",
+    "rcpspt_requests_total{status=\"rejected\"}",
+    "rcpspt_passes_total",
+    "rcpspt_pruned_passes_total",
+    "rcpspt_improvements_total",
+    "rcpspt_degraded_requests_total"
+};
+
+const char* phaseNames[NPHASES] = {"parse", "preprocess", "passes", "validate"};
+
+/**
+ * @return the resident set size of the process in bytes, or 0 if it cannot be read
+ */
+uint64_t residentSetSize() {
+    std::ifstream statm("/proc/self/statm");
+    uint64_t size = 0, resident = 0;
+    if (!(statm >> size >> resident)) return 0;
+    return resident * (uint64_t)sysconf(_SC_PAGESIZE);
+}
+}
+
+void Metrics::add(Counter counter, uint64_t n) {
+    increment(localShard().counters[(int)counter], n);
+}
+
+void Metrics::observe(Phase phase, double milis) {
+    Shard& shard = localShard();
+    int bucket = 0;
+    while (bucket < NBUCKETS && milis > bucketBounds[bucket]) bucket++;
+    increment(shard.buckets[(int)phase][bucket], 1);
+    increment(shard.micros[(int)phase], (uint64_t)(milis * 1000));
+}
+
+uint64_t Metrics::get(Counter counter) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    uint64_t total = r.retired.counters[(int)counter].load(std::memory_order_relaxed);
+    for (const std::unique_ptr<Shard>& shard : r.shards)
+        total += shard->counters[(int)counter].load(std::memory_order_relaxed);
+    return total;
+}
+
+void Metrics::write(std::ostream& output, int queueDepth) {
+    // Sum the shards
+    Shard total;
+    Registry& r = registry();
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        accumulate(total, r.retired);
+        for (const std::unique_ptr<Shard>& shard : r.shards) accumulate(total, *shard);
+    }
+    uint64_t counters[NCOUNTERS], buckets[NPHASES][NBUCKETS + 1], micros[NPHASES];
+    for (int i = 0; i < NCOUNTERS; i++) counters[i] = total.counters[i].load(std::memory_order_relaxed);
+    for (int p = 0; p < NPHASES; p++) {
+        for (int b = 0; b <= NBUCKETS; b++) buckets[p][b] = total.buckets[p][b].load(std::memory_order_relaxed);
+        micros[p] = total.micros[p].load(std::memory_order_relaxed);
+    }
+
+    output << "# TYPE rcpspt_requests_total counter\n";
+    for (int i = 0; i < (int)Counter::Passes; i++) output << counterNames[i] << " " << counters[i] << "\n";
+    for (int i = (int)Counter::Passes; i < NCOUNTERS; i++) {
+        output << "# TYPE " << counterNames[i] << " counter\n";
+        output << counterNames[i] << " " << counters[i] << "\n";
+    }
+
+    output << "# TYPE rcpspt_phase_duration_milliseconds histogram\n";
+    for (int p = 0; p < NPHASES; p++) {
+        uint64_t cumulative = 0;
+        for (int b = 0; b <= NBUCKETS; b++) {
+            cumulative += buckets[p][b];
+            output << "rcpspt_phase_duration_milliseconds_bucket{phase=\"" << phaseNames[p] << "\",le=\"";
+            if (b < NBUCKETS) output << bucketBounds[b];
+            else output << "+Inf";
+            output << "\"} " << cumulative << "\n";
+        }
+        output << "rcpspt_phase_duration_milliseconds_sum{phase=\"" << phaseNames[p] << "\"} " << micros[p] / 1000.0
+               << "\n";
+        output << "rcpspt_phase_duration_milliseconds_count{phase=\"" << phaseNames[p] << "\"} " << cumulative << "\n";
+    }
+
+    std::chrono::duration<double> uptime = std::chrono::steady_clock::now() - r.startTime;
+    output << "# TYPE rcpspt_passes_per_second gauge\n";
+    output << "rcpspt_passes_per_second " << counters[(int)Counter::Passes] / uptime.count() << "\n";
+    output << "# TYPE rcpspt_queue_depth gauge\n";
+    output << "rcpspt_queue_depth " << queueDepth << "\n";
+    output << "# TYPE rcpspt_resident_memory_bytes gauge\n";
+    output << "rcpspt_resident_memory_bytes " << residentSetSize() << "\n";
+}
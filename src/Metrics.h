@@ -0,0 +1,105 @@
+/***************************************************************************************[Metrics.h]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#ifndef RCPSPT_HEURISTIC_METRICS_H
+#define RCPSPT_HEURISTIC_METRICS_H
+
+#include <cstdint>
+#include <ostream>
+
+namespace RcpsptHeuristic {
+
+/**
+ * Event counters of the process.
+ */
+enum class Counter {
+    RequestsFound,      // Requests that finished with a schedule
+    RequestsInfeasible, // Requests of which preprocessing found the instance to be infeasible
+    RequestsNoSolution, // Requests that finished without a schedule
+    RequestsCancelled,  // Requests that were cancelled before they finished
+    RequestsFailed,     // Requests that could not be parsed or were invalid
+    RequestsRejected,   // Requests that were not admitted because they could not meet their deadline
+    Passes,             // Passes that were run
+    PrunedPasses,       // Passes that were aborted because an activity could not be placed within the horizon
+    Improvements,       // Improvements of an incumbent
+    DegradedRequests,   // Requests that were admitted with fewer passes than requested, because of load or deadline
+    Count
+};
+
+/**
+ * Phases of a request of which the duration is recorded.
+ */
+enum class Phase {
+    Parse,      // Reading the instance
+    Preprocess, // Calculating the priority values
+    Passes,     // Running the passes of a solver run
+    Validate,   // Checking the final schedule
+    Count
+};
+
+/**
+ * Process-wide counters and latency histograms. Recording is lock-free: each thread updates its own shard with
+ * relaxed atomic operations, and the shards are only summed when the metrics are written.
+ */
+class Metrics {
+public:
+    /**
+     * Upper bounds of the latency histogram buckets in milliseconds (the last bucket is unbounded).
+     */
+    static constexpr int NBUCKETS = 10;
+    static const double bucketBounds[NBUCKETS];
+
+    /**
+     * Increases a counter.
+     *
+     * @param counter the counter
+     * @param n the amount to add
+     */
+    static void add(Counter counter, uint64_t n = 1);
+
+    /**
+     * Records the duration of a phase.
+     *
+     * @param phase the phase
+     * @param milis the duration in milliseconds
+     */
+    static void observe(Phase phase, double milis);
+
+    /**
+     * @param counter the counter
+     * @return the sum of the counter over all threads
+     */
+    static uint64_t get(Counter counter);
+
+    /**
+     * Writes all metrics in the Prometheus text exposition format (version 0.0.4): the counters, the phase latency
+     * histograms, the average number of passes per second since the start of the process, the resident set size and
+     * the given queue depth.
+     *
+     * @param output the stream to write to
+     * @param queueDepth the number of requests that wait to be solved
+     */
+    static void write(std::ostream& output, int queueDepth);
+};
+}
+
+#endif //RCPSPT_HEURISTIC_METRICS_H
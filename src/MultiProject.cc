@@ -0,0 +1,100 @@
+/*********************************************************************************[MultiProject.cc]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#include "MultiProject.h"
+
+using namespace RcpsptHeuristic;
+
+MultiProject::MultiProject(const std::vector<const Problem*>& projects, const std::vector<double>& priorities,
+                           const std::vector<int>& dueDates) {
+    const Problem& pool = *projects.front();
+
+    // Source, activities and completion dummy of each project, sink
+    int njobs = 2;
+    for (const Problem* project : projects) njobs += project->njobs - 1;
+    problem = new Problem(njobs, pool.horizon, pool.nresources);
+    weights = new double[njobs];
+    int sink = njobs - 1;
+
+    std::vector<std::vector<int>> successors(njobs);
+    int next = 1;
+    for (int p = 0; p < (int)projects.size(); p++) {
+        const Problem& project = *projects[p];
+        ProjectInfo info{priorities[p], dueDates[p], next, project.njobs - 2, next + project.njobs - 2};
+        this->projects.push_back(info);
+
+        // Activities with an earlier due date are more urgent
+        double urgency = info.dueDate > 0 ? (double)pool.horizon / info.dueDate : 1.0;
+
+        // The source and sink of the project are mapped to the common source and the completion dummy
+        auto map = [&](int job) { return job == 0 ? 0 : (job == project.njobs - 1 ? info.endJob : info.firstJob + job - 1); };
+        for (int job = 0; job < project.njobs - 1; job++) {
+            int mapped = map(job);
+            for (int i = 0; i < project.nsuccessors[job]; i++) successors[mapped].push_back(map(project.successors[job][i]));
+            if (job == 0) continue;
+
+            problem->durations[mapped] = project.durations[job];
+            weights[mapped] = info.priority * urgency;
+            for (int k = 0; k < pool.nresources; k++) {
+                const int* request = project.requests[job][k];
+                if (request == nullptr) {
+                    problem->requests[mapped][k] = nullptr;
+                    continue;
+                }
+                problem->requests[mapped][k] = new int[project.durations[job]];
+                for (int t = 0; t < project.durations[job]; t++) problem->requests[mapped][k][t] = request[t];
+            }
+        }
+
+        // Completion dummy of the project
+        problem->durations[info.endJob] = 0;
+        weights[info.endJob] = info.priority * urgency;
+        for (int k = 0; k < pool.nresources; k++) problem->requests[info.endJob][k] = nullptr;
+        successors[info.endJob].push_back(sink);
+        next = info.endJob + 1;
+    }
+
+    // Common source and sink
+    for (int job : {0, sink}) {
+        problem->durations[job] = 0;
+        weights[job] = 1.0;
+        for (int k = 0; k < pool.nresources; k++) problem->requests[job][k] = nullptr;
+    }
+
+    for (int job = 0; job < njobs; job++) {
+        problem->nsuccessors[job] = (int)successors[job].size();
+        problem->successors[job] = new int[successors[job].size()];
+        for (int i = 0; i < (int)successors[job].size(); i++) {
+            problem->successors[job][i] = successors[job][i];
+            problem->predecessors[successors[job][i]].push_back(job);
+        }
+    }
+
+    for (int k = 0; k < pool.nresources; k++) problem->copyCapacities(k, pool, k);
+
+    problem->indexRequests();
+}
+
+MultiProject::~MultiProject() {
+    delete problem;
+    delete[] weights;
+}
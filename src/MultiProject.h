@@ -0,0 +1,70 @@
+/**********************************************************************************[MultiProject.h]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#ifndef RCPSPT_HEURISTIC_MULTIPROJECT_H
+#define RCPSPT_HEURISTIC_MULTIPROJECT_H
+
+#include <vector>
+
+#include "Problem.h"
+
+namespace RcpsptHeuristic {
+
+/**
+ * Project that is part of a multi-project problem.
+ */
+struct ProjectInfo {
+    double priority; // Relative priority of the project
+    int dueDate;     // Due date of the project, or -1 if it has none
+    int firstJob;    // Index of the first activity of the project in the combined problem
+    int njobs;       // Number of (non-dummy) activities of the project
+    int endJob;      // Index of the dummy activity in the combined problem that marks the completion of the project
+};
+
+/**
+ * Multiple projects combined into a single problem, in which they compete for shared resources. The combined problem
+ * has a common source and sink, and a dummy activity per project that marks its completion. The resource capacities
+ * (and horizon) of the first project define the shared resource pool.
+ */
+class MultiProject {
+public:
+    /**
+     * Combines the projects into a single problem. All projects should have the same number of resources.
+     *
+     * @param projects the projects to combine
+     * @param priorities the relative priority of each project (activities of projects with a higher priority are
+     *                   preferred in tournaments)
+     * @param dueDates the due date of each project, or -1 if it has none (activities of projects with earlier due
+     *                 dates are preferred in tournaments)
+     */
+    MultiProject(const std::vector<const Problem*>& projects, const std::vector<double>& priorities,
+                 const std::vector<int>& dueDates);
+    // Destructor
+    ~MultiProject();
+
+    Problem* problem;                  // The combined problem
+    std::vector<ProjectInfo> projects; // Information on each project
+    double* weights;                   // Priority weight of each activity in the combined problem
+};
+}
+
+#endif //RCPSPT_HEURISTIC_MULTIPROJECT_H
@@ -23,32 +23,84 @@ SOFTWARE.
 #include <iostream>
 #include <fstream>
 #include <regex>
-#include <cassert>
+#include <charconv>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
 
 #include "Parser.h"
 
 using namespace RcpsptHeuristic;
 
-static void tokenize(const string& str, vector<string>& out) {
+/**
+ * Splits a line into tokens that point into the line (separated by spaces and carriage returns).
+ */
+static void tokenize(std::string_view line, vector<std::string_view>& out) {
     out.clear();
-    int i = 0;
-    int n = (int)str.size();
+    size_t i = 0;
+    size_t n = line.size();
     while (i < n) {
-        while ((str[i] == ' ' || str[i] == '\n' || str[i] == '\r') && i < n) i++;
-        std::string token;
-        while (str[i] != ' ' && str[i] != '\n' && str[i] != '\r' && i < n) token.push_back(str[i++]);
-        if (!token.empty()) out.push_back(token);
+        while (i < n && (line[i] == ' ' || line[i] == '\r')) i++;
+        size_t begin = i;
+        while (i < n && line[i] != ' ' && line[i] != '\r') i++;
+        if (i > begin) out.push_back(line.substr(begin, i - begin));
     }
 }
 
+/**
+ * Parses an integer token (like std::stoi, but without copying the token).
+ */
+static int toInt(std::string_view token) {
+    int value = 0;
+    const char* begin = token.data();
+    if (begin != token.data() + token.size() && *begin == '+') begin++;
+    std::from_chars_result result = std::from_chars(begin, token.data() + token.size(), value);
+    if (result.ec != std::errc()) throw std::invalid_argument("invalid integer: " + std::string(token));
+    return value;
+}
+
+/**
+ * Rejects a malformed instance file (the input may come from a client of the daemon or the C API, so this must not
+ * assert).
+ */
+static void require(bool condition, const char* message) {
+    if (!condition) throw std::invalid_argument(message);
+}
+
+/**
+ * Reads the next line (without the line break) from a buffer.
+ *
+ * @param data the buffer
+ * @param size the size of the buffer
+ * @param position the offset of the next line, advanced past its line break
+ * @param line the line
+ * @return false if the end of the buffer was reached, true otherwise
+ */
+static bool nextLine(const char* data, size_t size, size_t& position, std::string_view& line) {
+    if (position >= size) return false;
+    const char* begin = data + position;
+    const char* end = (const char*)memchr(begin, '\n', size - position);
+    if (end == nullptr) end = data + size;
+    line = std::string_view(begin, end - begin);
+    position = end - data + 1;
+    return true;
+}
+
 Problem Parser::parseProblemInstance(ifstream& input) {
-    string line;
-    vector<string> tokens;
+    std::string data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    return parseProblemInstance(data.data(), data.size());
+}
+
+Problem Parser::parseProblemInstance(const char* data, size_t size) {
+    size_t position = 0;
+    std::string_view line;
+    vector<std::string_view> tokens;
 
     int section = 0; // File sections are separated by a line of stars ('*')
     int njobs = -1, horizon = -1, nresources = -1;
 
-    while(section <= 2 && getline(input, line)) {
+    while(section <= 2 && nextLine(data, size, position, line)) {
         if (line.empty()) continue;
         if (line[0] == '*') {
             section++;
@@ -58,21 +110,21 @@ Problem Parser::parseProblemInstance(ifstream& input) {
         if (section == 1) continue; // Section 1 does not contain relevant data
 
         tokenize(line, tokens);
-        if (section == 2) {
-            if (tokens.front() == "jobs") njobs = std::stoi(tokens.back());
-            else if (tokens.front() == "horizon") horizon = std::stoi(tokens.back());
-            else if (tokens.back() == "R") nresources = std::stoi(tokens[tokens.size() - 2]);
+        if (section == 2 && !tokens.empty()) {
+            if (tokens.front() == "jobs") njobs = toInt(tokens.back());
+            else if (tokens.front() == "horizon") horizon = toInt(tokens.back());
+            else if (tokens.back() == "R") nresources = toInt(tokens[tokens.size() - 2]);
             continue;
         }
     }
 
-    assert((njobs > -1) && "njobs was not successfully parsed");
-    assert((horizon > -1) && "horizon was not successfully parsed");
-    assert((nresources > -1) && "nresources was not successfully parsed");
+    require(njobs > 0, "njobs was not successfully parsed");
+    require(horizon > 0, "horizon was not successfully parsed");
+    require(nresources >= 0, "nresources was not successfully parsed");
     Problem result(njobs, horizon, nresources);
 
     int currJob = -1, currResource = 0; // Variables used for parsing related consecutive lines
-    while (getline(input, line)) {
+    while (nextLine(data, size, position, line)) {
         if (line.empty()) continue;
         if (line[0] == '*') {
             section++;
@@ -82,14 +134,19 @@ Problem Parser::parseProblemInstance(ifstream& input) {
         if (section == 3) continue; // Section "PROJECT INFORMATION" does not contain relevant data
 
         tokenize(line, tokens);
+        if (tokens.empty()) continue;
         if (section == 4) { // Section "PRECEDENCE RELATIONS"
             if (tokens.front() == "PRECEDENCE" || tokens.front() == "jobnr.") continue;
-            int job = std::stoi(tokens.front()) - 1; // Subtract 1 for zero-indexed array indexing
-            int nsucc = std::stoi(tokens[2]);
+            require(tokens.size() >= 3, "truncated precedence relation");
+            int job = toInt(tokens.front()) - 1; // Subtract 1 for zero-indexed array indexing
+            int nsucc = toInt(tokens[2]);
+            require(job >= 0 && job < njobs && result.successors[job] == nullptr, "invalid job in precedence relation");
+            require(nsucc >= 0 && (int)tokens.size() >= 3 + nsucc, "invalid number of successors");
             result.nsuccessors[job] = nsucc;
             result.successors[job] = new int[nsucc];
             for (int i = 0; i < nsucc; i++) {
-                int successor = std::stoi(tokens[3 + i]) - 1;
+                int successor = toInt(tokens[3 + i]) - 1;
+                require(successor >= 0 && successor < njobs, "invalid successor");
                 result.successors[job][i] = successor;
                 result.predecessors[successor].push_back(job);
             }
@@ -99,32 +156,44 @@ Problem Parser::parseProblemInstance(ifstream& input) {
             if (tokens.front()[0] == '-') continue;
             if (tokens.front() == "jobnr.") continue;
             if (currResource == 0 && tokens.size() <= 3) { // This is a dummy job
-                currJob = std::stoi(tokens.front()) - 1;
+                currJob = toInt(tokens.front()) - 1;
+                require(currJob >= 0 && currJob < njobs && (nresources == 0 || result.requests[currJob][0] == nullptr),
+                        "invalid job in requests/durations");
                 result.durations[currJob] = 0;
-                for (int i = 0; i < nresources; i++) result.requests[currJob][i] = new int[0];
                 continue;
             }
             if (currResource == 0) { // First line for a job
-                currJob = std::stoi(tokens.front()) - 1;
-                result.durations[currJob] = std::stoi(tokens[2]);
+                require(tokens.size() >= 3, "truncated requests/durations");
+                currJob = toInt(tokens.front()) - 1;
+                require(currJob >= 0 && currJob < njobs && (nresources == 0 || result.requests[currJob][0] == nullptr),
+                        "invalid job in requests/durations");
+                result.durations[currJob] = toInt(tokens[2]);
+                require(result.durations[currJob] >= 0 && result.durations[currJob] <= horizon
+                        && (int)tokens.size() >= 3 + result.durations[currJob], "invalid duration");
+                if (nresources == 0) continue;
                 result.requests[currJob][currResource] = new int[result.durations[currJob]];
                 for (int i = 0; i < result.durations[currJob]; i++)
-                    result.requests[currJob][currResource][i] = std::stoi(tokens[3 + i]);
+                    result.requests[currJob][currResource][i] = toInt(tokens[3 + i]);
             }
             else { // Remaining lines for a job
+                require((int)tokens.size() >= result.durations[currJob], "truncated requests/durations");
                 result.requests[currJob][currResource] = new int[result.durations[currJob]];
                 for (int i = 0; i < result.durations[currJob]; i++)
-                    result.requests[currJob][currResource][i] = std::stoi(tokens[i]);
+                    result.requests[currJob][currResource][i] = toInt(tokens[i]);
             }
             currResource = (currResource + 1) % nresources;
         }
         else if (section == 6) { // Section "RESOURCEAVAILABILITIES"
-            if ((int)tokens.size() <= 2 * nresources) continue;
+            if (nresources == 0 || (int)tokens.size() <= 2 * nresources) continue;
+            require((int)tokens.size() <= horizon, "resource availabilities exceed the horizon");
             for (int i = 0; i < (int)tokens.size(); i++)
-                result.capacities[currResource][i] = std::stoi(tokens[i]);
+                result.capacities[currResource][i] = toInt(tokens[i]);
             currResource = (currResource + 1) % nresources;
         }
     }
 
+    require(currResource == 0, "truncated requests/durations");
+    result.indexRequests();
+    result.compressCapacities();
     return result;
 }
@@ -43,6 +43,16 @@ public:
      * @return the Problem instance containing the parsed data
      */
     static Problem parseProblemInstance(ifstream& input);
+
+    /**
+     * Parses an instance of the RCPSP/t from the contents of a .smt file (see above), without copying the contents
+     * into lines or tokens.
+     *
+     * @param data the contents of the file
+     * @param size the size of the contents in bytes
+     * @return the Problem instance containing the parsed data
+     */
+    static Problem parseProblemInstance(const char* data, size_t size);
 };
 }
 
@@ -30,20 +30,24 @@ Problem::Problem(int njobs, int horizon, int nresources)
     : njobs(njobs),
       horizon(horizon),
       nresources(nresources),
-      nsuccessors(new int[njobs]),
-      successors(new int*[njobs]),
+      nsuccessors(new int[njobs]()),
+      successors(new int*[njobs]()),
       predecessors(new std::vector<int>[njobs]),
-      durations(new int[njobs]),
+      durations(new int[njobs]()),
       requests(new int**[njobs]),
-      capacities(new int*[nresources]) {
+      nused(new int[njobs]()),
+      used(new int*[njobs]()),
+      capacities(new int*[nresources]),
+      periods(new int[nresources]()),
+      exceptions(new std::vector<std::pair<int, int>>[nresources]) {
     for (int i = 0; i < njobs; i++)
         predecessors[i] = std::vector<int>();
 
     for (int i = 0; i < njobs; i++)
-        requests[i] = new int*[nresources];
+        requests[i] = new int*[nresources]();
 
     for (int i = 0; i < nresources; i++)
-        capacities[i] = new int[horizon];
+        capacities[i] = new int[horizon]();
 }
 
 Problem::~Problem() {
@@ -66,6 +70,277 @@ Problem::~Problem() {
     }
     delete[] requests;
 
+    for (i = 0; i < njobs; i++) delete[] used[i];
+    delete[] used;
+    delete[] nused;
+
     for (i = 0; i < nresources; i++) delete[] capacities[i];
     delete[] capacities;
+    delete[] periods;
+    delete[] exceptions;
+}
+
+void Problem::indexRequests() {
+    for (int i = 0; i < njobs; i++) {
+        delete[] used[i];
+        used[i] = new int[nresources];
+        nused[i] = 0;
+        for (int k = 0; k < nresources; k++) {
+            if (requests[i][k] == nullptr) continue;
+            bool zero = true;
+            for (int t = 0; zero && t < durations[i]; t++)
+                if (requests[i][k][t] != 0) zero = false;
+            if (zero) {
+                delete[] requests[i][k];
+                requests[i][k] = nullptr;
+            }
+            else used[i][nused[i]++] = k;
+        }
+    }
+}
+
+void Problem::compressCapacities() {
+    std::vector<int> border(horizon);
+    for (int k = 0; k < nresources; k++) {
+        if (periods[k] != 0 || horizon == 0) continue;
+
+        // The smallest period follows from the longest proper border (prefix that is also a suffix) of the capacities
+        const int* values = capacities[k];
+        border[0] = 0;
+        for (int t = 1; t < horizon; t++) {
+            int length = border[t - 1];
+            while (length > 0 && values[t] != values[length]) length = border[length - 1];
+            border[t] = values[t] == values[length] ? length + 1 : length;
+        }
+        int period = horizon - border[horizon - 1];
+        if (period <= horizon / 2) setCalendar(k, period, values);
+    }
+}
+
+void Problem::setCalendar(int k, int period, const int* calendar) {
+    int* values = new int[period];
+    for (int t = 0; t < period; t++) values[t] = calendar[t];
+    delete[] capacities[k];
+    capacities[k] = values;
+    periods[k] = period;
+    exceptions[k].clear();
+}
+
+void Problem::copyCapacities(int k, const Problem& source, int sourceResource) {
+    int period = source.periods[sourceResource];
+    if (period != 0) {
+        setCalendar(k, period, source.capacities[sourceResource]);
+        exceptions[k] = source.exceptions[sourceResource];
+        return;
+    }
+    if (periods[k] != 0) {
+        delete[] capacities[k];
+        capacities[k] = new int[horizon];
+        periods[k] = 0;
+        exceptions[k].clear();
+    }
+    for (int t = 0; t < horizon; t++) capacities[k][t] = source.capacities[sourceResource][t];
+}
+
+void Problem::setCapacity(int k, int t, int value) {
+    if (periods[k] == 0) {
+        capacities[k][t] = value;
+        return;
+    }
+    auto it = std::lower_bound(exceptions[k].begin(), exceptions[k].end(), std::make_pair(t, INT32_MIN));
+    bool found = it != exceptions[k].end() && it->first == t;
+    if (value == capacities[k][t % periods[k]]) {
+        if (found) exceptions[k].erase(it);
+    }
+    else if (found) it->second = value;
+    else exceptions[k].insert(it, std::make_pair(t, value));
+}
+
+void Problem::fillCapacities(int k, int from, int to, int* out) const {
+    if (periods[k] == 0) {
+        std::copy(capacities[k] + from, capacities[k] + to, out);
+        return;
+    }
+
+    // Copy the calendar one period (or part of it) at a time, then apply the exceptions
+    int period = periods[k];
+    for (int t = from; t < to;) {
+        int offset = t % period;
+        int length = std::min(period - offset, to - t);
+        std::copy(capacities[k] + offset, capacities[k] + offset + length, out + (t - from));
+        t += length;
+    }
+    auto it = std::lower_bound(exceptions[k].begin(), exceptions[k].end(), std::make_pair(from, INT32_MIN));
+    for (; it != exceptions[k].end() && it->first < to; ++it) out[it->first - from] = it->second;
+}
+
+Problem* Problem::subproblem(const std::vector<int>& jobs, const std::vector<int>& resources) const {
+    int nsubjobs = (int)jobs.size(), nsubresources = (int)resources.size();
+    Problem* result = new Problem(nsubjobs, horizon, nsubresources);
+
+    std::vector<int> jobIndex(njobs, -1);
+    for (int i = 0; i < nsubjobs; i++) jobIndex[jobs[i]] = i;
+
+    for (int i = 0; i < nsubjobs; i++) {
+        int job = jobs[i];
+        std::vector<int> kept;
+        for (int j = 0; j < nsuccessors[job]; j++)
+            if (jobIndex[successors[job][j]] >= 0) kept.push_back(jobIndex[successors[job][j]]);
+        result->nsuccessors[i] = (int)kept.size();
+        result->successors[i] = new int[kept.size()];
+        for (int j = 0; j < (int)kept.size(); j++) {
+            result->successors[i][j] = kept[j];
+            result->predecessors[kept[j]].push_back(i);
+        }
+
+        result->durations[i] = durations[job];
+        for (int k = 0; k < nsubresources; k++) {
+            const int* request = requests[job][resources[k]];
+            if (request == nullptr) {
+                result->requests[i][k] = nullptr;
+                continue;
+            }
+            result->requests[i][k] = new int[durations[job]];
+            for (int t = 0; t < durations[job]; t++) result->requests[i][k][t] = request[t];
+        }
+    }
+
+    for (int k = 0; k < nsubresources; k++) result->copyCapacities(k, *this, resources[k]);
+
+    result->indexRequests();
+    return result;
+}
+
+Problem* Problem::contractChains(std::vector<std::vector<int>>& chains) const {
+    // An activity continues the chain of its predecessor if they are linked only to each other (dummies excluded)
+    int sink = njobs - 1;
+    auto continues = [&](int job) {
+        if (job == 0 || job == sink || predecessors[job].size() != 1) return false;
+        int predecessor = predecessors[job][0];
+        return predecessor != 0 && nsuccessors[predecessor] == 1;
+    };
+
+    chains.clear();
+    std::vector<int> chainIndex(njobs, -1);
+    for (int job = 0; job < njobs; job++) {
+        if (continues(job)) continue;
+        chainIndex[job] = (int)chains.size();
+        chains.emplace_back(1, job);
+        for (int member = job; nsuccessors[member] == 1 && continues(successors[member][0]);) {
+            member = successors[member][0];
+            chains.back().push_back(member);
+        }
+    }
+
+    int ncomposite = (int)chains.size();
+    Problem* result = new Problem(ncomposite, horizon, nresources);
+    for (int i = 0; i < ncomposite; i++) {
+        const std::vector<int>& chain = chains[i];
+
+        // The successors of the last activity of a chain each start a chain
+        int last = chain.back();
+        result->nsuccessors[i] = nsuccessors[last];
+        result->successors[i] = new int[nsuccessors[last]];
+        for (int j = 0; j < nsuccessors[last]; j++) {
+            int successor = chainIndex[successors[last][j]];
+            result->successors[i][j] = successor;
+            result->predecessors[successor].push_back(i);
+        }
+
+        int duration = 0;
+        for (int member : chain) duration += durations[member];
+        result->durations[i] = duration;
+        for (int k = 0; k < nresources; k++) {
+            bool zero = true;
+            for (int member : chain)
+                if (requests[member][k] != nullptr) zero = false;
+            if (zero) {
+                result->requests[i][k] = nullptr;
+                continue;
+            }
+            int* request = new int[duration];
+            int offset = 0;
+            for (int member : chain) {
+                for (int t = 0; t < durations[member]; t++)
+                    request[offset + t] = requests[member][k] != nullptr ? requests[member][k][t] : 0;
+                offset += durations[member];
+            }
+            result->requests[i][k] = request;
+        }
+    }
+
+    for (int k = 0; k < nresources; k++) result->copyCapacities(k, *this, k);
+
+    result->indexRequests();
+    return result;
+}
+
+void Problem::expandChains(const std::vector<std::vector<int>>& chains, const int* contracted, int* out) const {
+    for (int i = 0; i < (int)chains.size(); i++) {
+        // Activities of a chain end one after the other, the last one at the end of the composite activity
+        int finish = contracted[i];
+        for (int j = (int)chains[i].size() - 1; j >= 0; j--) {
+            out[chains[i][j]] = finish;
+            finish -= durations[chains[i][j]];
+        }
+    }
+}
+
+bool Problem::validate(const int* schedule, std::string* error) const {
+    auto fail = [&](const std::string& message) {
+        if (error != nullptr) *error = message;
+        return false;
+    };
+
+    for (int job = 0; job < njobs; job++) {
+        if (schedule[job] - durations[job] < 0 || schedule[job] > horizon) return fail("activity outside the horizon!");
+        // Precedence constraints
+        for (int predecessor : predecessors[job])
+            if (schedule[job] - durations[job] < schedule[predecessor]) return fail("invalid precedence!");
+    }
+
+    // Resource constraints
+    std::vector<int> available(horizon);
+    for (int k = 0; k < nresources; k++) {
+        fillCapacities(k, 0, horizon, available.data());
+        for (int job = 0; job < njobs; job++) {
+            if (requests[job][k] == nullptr) continue;
+            int start = schedule[job] - durations[job];
+            for (int t = 0; t < durations[job]; t++) {
+                available[start + t] -= requests[job][k][t];
+                if (available[start + t] < 0)
+                    return fail("resource demand exceeds availability at t=" + std::to_string(start + t) + "!");
+            }
+        }
+    }
+    return true;
+}
+
+static inline void hashValue(uint64_t& hash, int value) {
+    for (int i = 0; i < 4; i++) {
+        hash ^= (uint64_t)((value >> (8 * i)) & 0xff);
+        hash *= 1099511628211ULL; // FNV-1a 64-bit prime
+    }
+}
+
+uint64_t Problem::fingerprint() const {
+    uint64_t hash = 14695981039346656037ULL; // FNV-1a 64-bit offset basis
+
+    hashValue(hash, njobs);
+    hashValue(hash, horizon);
+    hashValue(hash, nresources);
+    for (int i = 0; i < njobs; i++) {
+        hashValue(hash, nsuccessors[i]);
+        for (int j = 0; j < nsuccessors[i]; j++) hashValue(hash, successors[i][j]);
+        hashValue(hash, durations[i]);
+        for (int k = 0; k < nresources; k++) // Unused resources are hashed as zeros, as they appear in the input
+            for (int t = 0; t < durations[i]; t++) hashValue(hash, requests[i][k] != nullptr ? requests[i][k][t] : 0);
+    }
+    std::vector<int> values(horizon); // Periodic capacities are hashed as expanded over the horizon
+    for (int k = 0; k < nresources; k++) {
+        fillCapacities(k, 0, horizon, values.data());
+        for (int t = 0; t < horizon; t++) hashValue(hash, values[t]);
+    }
+
+    return hash;
 }
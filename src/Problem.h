@@ -24,6 +24,10 @@ SOFTWARE.
 #define RCPSPT_HEURISTIC_PROBLEM_H
 
 #include <vector>
+#include <string>
+#include <utility>
+#include <cstdint>
+#include <algorithm>
 
 namespace RcpsptHeuristic {
 
@@ -37,6 +41,105 @@ public:
     // Destructor
     virtual ~Problem();
 
+    /**
+     * Builds the list of used resources of each activity, and releases the request profiles that are all zeros
+     * (which are replaced by nullptr). Must be called once after the requests have been filled in.
+     */
+    void indexRequests();
+
+    /**
+     * Replaces the capacities of each resource by a periodic calendar when they repeat with a period of at most half the
+     * horizon. Must be called once after the capacities have been filled in.
+     */
+    void compressCapacities();
+
+    /**
+     * Sets a periodic calendar as the capacities of a resource, without exceptions.
+     *
+     * @param k the resource
+     * @param period the number of time steps after which the calendar repeats
+     * @param calendar the capacity for each time step of the period
+     */
+    void setCalendar(int k, int period, const int* calendar);
+
+    /**
+     * Copies the capacities (or calendar and exceptions) of a resource of another problem with the same horizon.
+     *
+     * @param k the resource of this problem
+     * @param source the other problem
+     * @param sourceResource the resource of the other problem
+     */
+    void copyCapacities(int k, const Problem& source, int sourceResource);
+
+    /**
+     * @return the capacity of a resource at a time step
+     */
+    int capacity(int k, int t) const {
+        if (periods[k] == 0) return capacities[k][t];
+        if (!exceptions[k].empty()) {
+            auto it = std::lower_bound(exceptions[k].begin(), exceptions[k].end(), std::make_pair(t, INT32_MIN));
+            if (it != exceptions[k].end() && it->first == t) return it->second;
+        }
+        return capacities[k][t % periods[k]];
+    }
+
+    /**
+     * Sets the capacity of a resource at a time step (as an exception to its calendar, if it is periodic).
+     */
+    void setCapacity(int k, int t, int value);
+
+    /**
+     * Writes the capacities of a resource for the time steps in [from, to), which must be within the horizon.
+     */
+    void fillCapacities(int k, int from, int to, int* out) const;
+
+    /**
+     * Creates the problem that is restricted to a subset of the activities and resources. Precedence relations between
+     * the selected activities, and the capacities of the selected resources, are kept.
+     *
+     * @param jobs the activities to keep, in their new order (should start with the source and end with the sink)
+     * @param resources the resources to keep, in their new order (should include all resources used by the activities)
+     * @return the restricted problem (to be deleted by the caller)
+     */
+    Problem* subproblem(const std::vector<int>& jobs, const std::vector<int>& resources) const;
+
+    /**
+     * Creates the problem in which each chain of activities (where an activity is the only successor of its
+     * predecessor, and that predecessor is its only predecessor) is contracted into a composite activity, which
+     * executes the activities of the chain directly after each other with their request profiles concatenated.
+     * Every schedule of the contracted problem can be expanded into a schedule of this problem.
+     *
+     * @param chains vector to which the activities of each activity of the contracted problem will be written, in
+     *        order of execution
+     * @return the contracted problem (to be deleted by the caller)
+     */
+    Problem* contractChains(std::vector<std::vector<int>>& chains) const;
+
+    /**
+     * Expands a schedule of a problem created by contractChains() into a schedule of this problem.
+     *
+     * @param chains the activities of each activity of the contracted problem, as written by contractChains()
+     * @param contracted end times for all activities of the contracted problem
+     * @param out vector to which end times for all activities of this problem will be written
+     */
+    void expandChains(const std::vector<std::vector<int>>& chains, const int* contracted, int* out) const;
+
+    /**
+     * Checks a schedule against the precedence relations, the horizon and the resource capacities.
+     *
+     * @param schedule end times for all activities
+     * @param error set to a description of the first violation (if not nullptr)
+     * @return true if the schedule is valid, false otherwise
+     */
+    bool validate(const int* schedule, std::string* error = nullptr) const;
+
+    /**
+     * Calculates a content hash of the instance data, which can be used to recognise the same instance across runs.
+     *
+     * @return 64-bit FNV-1a hash of the sizes, precedence relations, durations, requests and capacities
+     */
+    uint64_t fingerprint() const;
+
     // Data
 
     const int njobs;                // Number of activities (including dummy start and end activities)
@@ -46,8 +149,13 @@ public:
     int** successors;               // List of successors for each activity
     std::vector<int>* predecessors; // List of predecessors for each activity (for backwards traversal of the precedence graph)
     int* durations;                 // Duration for each activity
-    int*** requests;                // Request per time step, per resource, per activity
-    int** capacities;               // Capacity for each time step, per resource
+    int*** requests;                // Request per time step, per resource, per activity (nullptr if all zeros)
+    int* nused;                     // Amount of resources with a nonzero request that each activity has
+    int** used;                     // List of resources with a nonzero request for each activity
+    int** capacities;               // Capacity for each time step (of the period, if periodic), per resource
+    int* periods;                   // Period of the calendar of each resource, or 0 if its capacities are not periodic
+    std::vector<std::pair<int, int>>* exceptions; // Time steps (in increasing order) with their capacity, per periodic
+                                                  // resource, where the capacity differs from the calendar
 };
 }
 
@@ -0,0 +1,399 @@
+/**************************************************************************************[Profile.cc]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#include <algorithm>
+#include <cstring>
+#include <climits>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "Profile.h"
+
+using namespace RcpsptHeuristic;
+
+/**
+ * @return whether a[i] > b[i] for any i < n, where n is a multiple of SIMD_WIDTH
+ */
+static inline bool anyGreater(const int* a, const int* b, int n) {
+#ifdef __SSE2__
+    for (int i = 0; i < n; i += SIMD_WIDTH) {
+        __m128i greater = _mm_cmpgt_epi32(_mm_loadu_si128((const __m128i*)(a + i)), _mm_loadu_si128((const __m128i*)(b + i)));
+        if (_mm_movemask_epi8(greater) != 0) return true;
+    }
+#else
+    for (int i = 0; i < n; i++)
+        if (a[i] > b[i]) return true;
+#endif
+    return false;
+}
+
+/**
+ * Subtracts b from a (where b is not negative), and lowers m to the resulting values where they are smaller, for n
+ * values (multiple of SIMD_WIDTH).
+ */
+static inline void subtractAndLower(int* a, const int* b, int* m, int n) {
+#ifdef __SSE2__
+    for (int i = 0; i < n; i += SIMD_WIDTH) {
+        __m128i request = _mm_loadu_si128((const __m128i*)(b + i));
+        request = _mm_andnot_si128(_mm_srai_epi32(request, 31), request);
+        __m128i value = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(a + i)), request);
+        __m128i minimum = _mm_loadu_si128((const __m128i*)(m + i));
+        __m128i lower = _mm_cmplt_epi32(value, minimum);
+        _mm_storeu_si128((__m128i*)(a + i), value);
+        _mm_storeu_si128((__m128i*)(m + i), _mm_or_si128(_mm_and_si128(lower, value), _mm_andnot_si128(lower, minimum)));
+    }
+#else
+    for (int i = 0; i < n; i++) {
+        a[i] -= std::max(b[i], 0);
+        if (a[i] < m[i]) m[i] = a[i];
+    }
+#endif
+}
+
+ProfileSummary::ProfileSummary(const Problem& problem, Layout layout)
+    : njobs(problem.njobs),
+      nresources(problem.nresources),
+      layout(layout),
+      nblocks(((problem.horizon - 1) >> BLOCK_SHIFT) + 1),
+      maxRequests(new int*[problem.njobs]),
+      minRequests(new int*[problem.njobs]),
+      maxCapacities(new int[problem.nresources]),
+      capacityMinima(new int*[problem.nresources]),
+      stride(((problem.nresources + SIMD_WIDTH - 1) / SIMD_WIDTH) * SIMD_WIDTH),
+      interleavedRequests(nullptr),
+      interleavedMaxima(nullptr),
+      interleavedMinima(nullptr),
+      interleavedCapacities(nullptr),
+      interleavedBlocks(nullptr) {
+    for (int job = 0; job < problem.njobs; job++) {
+        maxRequests[job] = new int[problem.nresources];
+        minRequests[job] = new int[problem.nresources];
+        for (int k = 0; k < problem.nresources; k++) {
+            maxRequests[job][k] = 0;
+            minRequests[job][k] = 0;
+        }
+        for (int i = 0; i < problem.nused[job]; i++) {
+            int k = problem.used[job][i];
+            minRequests[job][k] = INT_MAX;
+            for (int t = 0; t < problem.durations[job]; t++) {
+                maxRequests[job][k] = std::max(maxRequests[job][k], problem.requests[job][k][t]);
+                minRequests[job][k] = std::min(minRequests[job][k], problem.requests[job][k][t]);
+            }
+        }
+    }
+
+    int* capacities = new int[problem.horizon];
+    for (int k = 0; k < problem.nresources; k++) {
+        maxCapacities[k] = 0;
+        capacityMinima[k] = new int[nblocks];
+        for (int b = 0; b < nblocks; b++) capacityMinima[k][b] = INT_MAX;
+        problem.fillCapacities(k, 0, problem.horizon, capacities);
+        for (int t = 0; t < problem.horizon; t++) {
+            maxCapacities[k] = std::max(maxCapacities[k], capacities[t]);
+            capacityMinima[k][t >> BLOCK_SHIFT] = std::min(capacityMinima[k][t >> BLOCK_SHIFT], capacities[t]);
+        }
+    }
+
+    if (layout != Layout::TimeMajor) {
+        delete[] capacities;
+        return;
+    }
+
+    // Interleave the data of all resources. The lanes of the resources that an activity does not use (and the padding
+    // lanes) request INT_MIN, so that they never exceed an availability, even the negative ones that a repair leaves.
+    interleavedRequests = new int*[njobs];
+    interleavedMaxima = new int*[njobs];
+    interleavedMinima = new int*[njobs];
+    for (int job = 0; job < njobs; job++) {
+        int duration = problem.durations[job];
+        interleavedRequests[job] = new int[duration * stride];
+        interleavedMaxima[job] = new int[stride];
+        interleavedMinima[job] = new int[stride];
+        std::fill(interleavedRequests[job], interleavedRequests[job] + duration * stride, INT_MIN);
+        std::fill(interleavedMaxima[job], interleavedMaxima[job] + stride, INT_MIN);
+        std::fill(interleavedMinima[job], interleavedMinima[job] + stride, INT_MIN);
+        for (int i = 0; i < problem.nused[job]; i++) {
+            int k = problem.used[job][i];
+            for (int t = 0; t < duration; t++) interleavedRequests[job][t * stride + k] = problem.requests[job][k][t];
+            interleavedMaxima[job][k] = maxRequests[job][k];
+            interleavedMinima[job][k] = minRequests[job][k];
+        }
+    }
+    interleavedCapacities = new int[problem.horizon * stride]();
+    interleavedBlocks = new int[nblocks * stride]();
+    for (int k = 0; k < nresources; k++) {
+        problem.fillCapacities(k, 0, problem.horizon, capacities);
+        for (int t = 0; t < problem.horizon; t++) interleavedCapacities[t * stride + k] = capacities[t];
+        for (int b = 0; b < nblocks; b++) interleavedBlocks[b * stride + k] = capacityMinima[k][b];
+    }
+    delete[] capacities;
+}
+
+ProfileSummary::~ProfileSummary() {
+    for (int job = 0; job < njobs; job++) {
+        delete[] maxRequests[job];
+        delete[] minRequests[job];
+    }
+    delete[] maxRequests;
+    delete[] minRequests;
+    delete[] maxCapacities;
+    for (int k = 0; k < nresources; k++) delete[] capacityMinima[k];
+    delete[] capacityMinima;
+
+    if (layout != Layout::TimeMajor) return;
+    for (int job = 0; job < njobs; job++) {
+        delete[] interleavedRequests[job];
+        delete[] interleavedMaxima[job];
+        delete[] interleavedMinima[job];
+    }
+    delete[] interleavedRequests;
+    delete[] interleavedMaxima;
+    delete[] interleavedMinima;
+    delete[] interleavedCapacities;
+    delete[] interleavedBlocks;
+}
+
+ResourceProfile::ResourceProfile(const Problem& problem, const ProfileSummary& summary)
+    : problem(problem),
+      summary(summary),
+      availabilities(nullptr),
+      minima(nullptr),
+      interleaved(nullptr),
+      blocks(nullptr) {
+    if (summary.layout == Layout::TimeMajor) {
+        interleaved = new int[problem.horizon * summary.stride];
+        blocks = new int[summary.nblocks * summary.stride];
+        return;
+    }
+
+    availabilities = new int*[problem.nresources];
+    minima = new int*[problem.nresources];
+    for (int k = 0; k < problem.nresources; k++) {
+        availabilities[k] = new int[problem.horizon];
+        minima[k] = new int[summary.nblocks];
+    }
+}
+
+ResourceProfile::~ResourceProfile() {
+    delete[] interleaved;
+    delete[] blocks;
+    if (availabilities == nullptr) return;
+    for (int k = 0; k < problem.nresources; k++) {
+        delete[] availabilities[k];
+        delete[] minima[k];
+    }
+    delete[] availabilities;
+    delete[] minima;
+}
+
+void ResourceProfile::reset() {
+    if (summary.layout == Layout::TimeMajor) {
+        std::memcpy(interleaved, summary.interleavedCapacities, problem.horizon * summary.stride * sizeof(int));
+        std::memcpy(blocks, summary.interleavedBlocks, summary.nblocks * summary.stride * sizeof(int));
+        return;
+    }
+
+    for (int k = 0; k < problem.nresources; k++) {
+        problem.fillCapacities(k, 0, problem.horizon, availabilities[k]);
+        std::memcpy(minima[k], summary.capacityMinima[k], summary.nblocks * sizeof(int));
+    }
+}
+
+void ResourceProfile::copy(const ResourceProfile& other, int from, int to) {
+    if (from >= to) return;
+    int firstBlock = from >> BLOCK_SHIFT, nblocks = ((to - 1) >> BLOCK_SHIFT) - firstBlock + 1;
+    if (summary.layout == Layout::TimeMajor) {
+        int stride = summary.stride;
+        std::memcpy(interleaved + from * stride, other.interleaved + from * stride, (to - from) * stride * sizeof(int));
+        std::memcpy(blocks + firstBlock * stride, other.blocks + firstBlock * stride, nblocks * stride * sizeof(int));
+        return;
+    }
+
+    for (int k = 0; k < problem.nresources; k++) {
+        std::memcpy(availabilities[k] + from, other.availabilities[k] + from, (to - from) * sizeof(int));
+        std::memcpy(minima[k] + firstBlock, other.minima[k] + firstBlock, nblocks * sizeof(int));
+    }
+}
+
+int ResourceProfile::earliestFinish(int job, int finish) const {
+    int duration = problem.durations[job];
+    const int* maxRequests = summary.maxRequests[job];
+    const int* minRequests = summary.minRequests[job];
+
+    const int* used = problem.used[job];
+    int nused = problem.nused[job];
+
+    // A request that exceeds every capacity can never be satisfied
+    for (int i = 0; i < nused; i++)
+        if (maxRequests[used[i]] > summary.maxCapacities[used[i]]) return problem.horizon + 1;
+
+    if (summary.layout == Layout::TimeMajor) return earliestFinishTimeMajor(job, finish);
+
+    while (finish <= problem.horizon) {
+        int start = finish - duration;
+        int conflict = -1; // Time step at which the activity does not fit, if any
+        for (int i = 0; conflict < 0 && i < nused; i++) {
+            int k = used[i];
+
+            // Fits regardless of the request profile if the maximum request does not exceed the block minima
+            int lowest = INT_MAX;
+            for (int b = start >> BLOCK_SHIFT; b <= (finish - 1) >> BLOCK_SHIFT; b++) lowest = std::min(lowest, minima[k][b]);
+            if (maxRequests[k] <= lowest) continue;
+
+            // Check the request profile against the availabilities
+            const int* requests = problem.requests[job][k];
+            const int* available = availabilities[k] + start;
+            for (int t = duration - 1; t >= 0; t--) {
+                if (requests[t] > available[t]) {
+                    conflict = start + t;
+                    // If even the minimum request does not fit at the conflict, no window containing it is feasible
+                    if (minRequests[k] > available[t]) finish = conflict + duration;
+                    break;
+                }
+            }
+        }
+        if (conflict < 0) return finish;
+        finish++;
+    }
+    return finish;
+}
+
+int ResourceProfile::earliestFinishTimeMajor(int job, int finish) const {
+    int duration = problem.durations[job];
+    int stride = summary.stride;
+    const int* requests = summary.interleavedRequests[job];
+    const int* maxRequests = summary.interleavedMaxima[job];
+    const int* minRequests = summary.interleavedMinima[job];
+
+    while (finish <= problem.horizon) {
+        int start = finish - duration;
+
+        // Fits regardless of the request profiles if the maximum requests do not exceed the block minima
+        bool fits = true;
+        for (int b = start >> BLOCK_SHIFT; fits && b <= (finish - 1) >> BLOCK_SHIFT; b++)
+            if (anyGreater(maxRequests, blocks + b * stride, stride)) fits = false;
+        if (fits) return finish;
+
+        // Check the request profiles of all resources against the availabilities, one time step at a time
+        int conflict = -1; // Time step at which the activity does not fit, if any
+        for (int t = duration - 1; t >= 0; t--) {
+            if (anyGreater(requests + t * stride, interleaved + (start + t) * stride, stride)) {
+                conflict = start + t;
+                break;
+            }
+        }
+        if (conflict < 0) return finish;
+
+        // If even the minimum request of a resource does not fit at the conflict, no window containing it is feasible
+        if (anyGreater(minRequests, interleaved + conflict * stride, stride)) finish = conflict + duration;
+        finish++;
+    }
+    return finish;
+}
+
+void ResourceProfile::place(int job, int finish) {
+    if (summary.layout == Layout::TimeMajor) {
+        placeTimeMajor(job, finish);
+        return;
+    }
+
+    int duration = problem.durations[job];
+    int start = finish - duration;
+
+    for (int i = 0; i < problem.nused[job]; i++) {
+        int k = problem.used[job][i];
+        int* available = availabilities[k];
+        int* blockMinima = minima[k];
+        for (int t = start; t < finish; t++) {
+            available[t] -= problem.requests[job][k][t - start];
+            if (available[t] < blockMinima[t >> BLOCK_SHIFT]) blockMinima[t >> BLOCK_SHIFT] = available[t];
+        }
+    }
+}
+
+void ResourceProfile::placeTimeMajor(int job, int finish) {
+    int stride = summary.stride;
+    const int* requests = summary.interleavedRequests[job];
+    for (int t = finish - problem.durations[job]; t < finish; t++, requests += stride)
+        subtractAndLower(interleaved + t * stride, requests, blocks + (t >> BLOCK_SHIFT) * stride, stride);
+}
+
+RollingProfile::RollingProfile(const Problem& problem, int size)
+    : problem(problem),
+      size(size),
+      first(0),
+      availabilities(new int*[problem.nresources]) {
+    for (int k = 0; k < problem.nresources; k++) availabilities[k] = new int[size];
+}
+
+RollingProfile::~RollingProfile() {
+    for (int k = 0; k < problem.nresources; k++) delete[] availabilities[k];
+    delete[] availabilities;
+}
+
+void RollingProfile::start(int begin) {
+    first = begin;
+    for (int k = 0; k < problem.nresources; k++)
+        for (int t = begin; t < begin + size; t++)
+            availabilities[k][t % size] = t < problem.horizon ? problem.capacity(k, t) : 0;
+}
+
+void RollingProfile::advance(int begin) {
+    for (int k = 0; k < problem.nresources; k++)
+        for (int t = std::max(first + size, begin); t < begin + size; t++)
+            availabilities[k][t % size] = t < problem.horizon ? problem.capacity(k, t) : 0;
+    first = begin;
+}
+
+void RollingProfile::copy(const RollingProfile& other) {
+    first = other.first;
+    for (int k = 0; k < problem.nresources; k++)
+        std::memcpy(availabilities[k], other.availabilities[k], size * sizeof(int));
+}
+
+int RollingProfile::earliestFinish(int job, int finish) const {
+    int duration = problem.durations[job];
+    finish = std::max(finish, first + duration);
+
+    for (; finish <= first + size; finish++) {
+        int start = finish - duration;
+        bool feasible = true;
+        for (int i = 0; feasible && i < problem.nused[job]; i++) {
+            int k = problem.used[job][i];
+            const int* requests = problem.requests[job][k];
+            for (int t = duration - 1; feasible && t >= 0; t--)
+                if (requests[t] > availabilities[k][(start + t) % size]) feasible = false;
+        }
+        if (feasible) return finish;
+    }
+    return finish;
+}
+
+void RollingProfile::place(int job, int finish) {
+    int duration = problem.durations[job];
+    int start = finish - duration;
+    for (int i = 0; i < problem.nused[job]; i++) {
+        int k = problem.used[job][i];
+        for (int t = 0; t < duration; t++) availabilities[k][(start + t) % size] -= problem.requests[job][k][t];
+    }
+}
@@ -0,0 +1,203 @@
+/***************************************************************************************[Profile.h]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#ifndef RCPSPT_HEURISTIC_PROFILE_H
+#define RCPSPT_HEURISTIC_PROFILE_H
+
+#include "Problem.h"
+
+#define BLOCK_SHIFT 4 // Time steps are grouped in blocks of 2^BLOCK_SHIFT for the block minima of availabilities
+#define SIMD_WIDTH 4  // Number of resources that are compared at once in the time-major layout (32-bit lanes of SSE)
+
+namespace RcpsptHeuristic {
+
+/**
+ * Memory layout of the remaining availabilities in a resource profile.
+ */
+enum class Layout {
+    ResourceMajor, // Availabilities of each resource are contiguous over time
+    TimeMajor      // Availabilities of all resources at a time step are contiguous (padded to SIMD_WIDTH), so that all
+                   // resources of a time step are compared in a single vector operation
+};
+
+/**
+ * Static data of a problem that is used by resource profiles for fast feasibility checks. It is computed once per
+ * problem and shared by all profiles (and threads).
+ */
+class ProfileSummary {
+public:
+    // Constructor
+    ProfileSummary(const Problem& problem, Layout layout);
+    // Destructor
+    ~ProfileSummary();
+
+    const int njobs;
+    const int nresources;
+    const Layout layout;
+    const int nblocks;      // Number of blocks of time steps that cover the horizon
+    int** maxRequests;      // Maximum request over all time steps, per resource, per activity
+    int** minRequests;      // Minimum request over all time steps, per resource, per activity
+    int* maxCapacities;     // Maximum capacity over the horizon, per resource
+    int** capacityMinima;   // Minimum capacity per block of time steps, per resource
+
+    // Time-major layout only (nullptr otherwise), with stride resources per time step or block
+    const int stride;           // Number of resources rounded up to a multiple of SIMD_WIDTH
+    int** interleavedRequests;  // Requests per resource, per time step, per activity (INT_MIN for unused resources)
+    int** interleavedMaxima;    // Maximum requests per resource, per activity (INT_MIN for unused resources)
+    int** interleavedMinima;    // Minimum requests per resource, per activity (INT_MIN for unused resources)
+    int* interleavedCapacities; // Capacities per resource, per time step
+    int* interleavedBlocks;     // Minimum capacities per resource, per block of time steps
+};
+
+/**
+ * Remaining resource availabilities during a pass of a schedule generation scheme. Besides the availabilities, the
+ * minimum availability per block of time steps is kept, so that most placement checks are decided without scanning
+ * the request profile of the activity:
+ *  - accepted when its maximum request does not exceed the minimum availability of the blocks covering its window;
+ *  - rejected when its maximum request exceeds every capacity, or when its minimum request exceeds the availability
+ *    at the time step of the last conflict (in which case all windows containing that time step are skipped).
+ * Availabilities only decrease during a pass, so the block minima are maintained in constant time per time step.
+ */
+class ResourceProfile {
+public:
+    // Constructor
+    ResourceProfile(const Problem& problem, const ProfileSummary& summary);
+    // Destructor
+    ~ResourceProfile();
+
+    /**
+     * Resets the remaining availabilities to the capacities.
+     */
+    void reset();
+
+    /**
+     * Finds the earliest finish time at or after the given time at which the activity fits in the remaining
+     * availabilities.
+     *
+     * @param job the activity to place
+     * @param finish the earliest finish time to consider (at least the duration of the activity)
+     * @return the earliest feasible finish time, or a value larger than the horizon if there is none
+     */
+    int earliestFinish(int job, int finish) const;
+
+    /**
+     * Subtracts the requests of the activity from the remaining availabilities.
+     *
+     * @param job the activity to place
+     * @param finish the finish time of the activity
+     */
+    void place(int job, int finish);
+
+    /**
+     * Copies the remaining availabilities of another profile of the same problem and summary in a range of time steps
+     * (e.g. to continue from the state after a common prefix of activities). The profiles must only differ within the
+     * range, since the block minima of all blocks that overlap it are copied as well.
+     *
+     * @param other the profile to copy from
+     * @param from the first time step to copy
+     * @param to the time step after the last time step to copy
+     */
+    void copy(const ResourceProfile& other, int from, int to);
+
+    /**
+     * @return the remaining availability of a resource at a time step
+     */
+    int available(int k, int t) const {
+        return summary.layout == Layout::TimeMajor ? interleaved[t * summary.stride + k] : availabilities[k][t];
+    }
+
+private:
+    int earliestFinishTimeMajor(int job, int finish) const;
+    void placeTimeMajor(int job, int finish);
+
+    const Problem& problem;
+    const ProfileSummary& summary;
+    int** availabilities; // Remaining availability per time step, per resource (resource-major layout)
+    int** minima;         // Minimum remaining availability per block of time steps, per resource (resource-major layout)
+    int* interleaved;     // Remaining availability per resource, per time step (time-major layout)
+    int* blocks;          // Minimum remaining availability per resource, per block of time steps (time-major layout)
+};
+
+/**
+ * Remaining resource availabilities in a window of time steps that moves forward over the horizon, stored in a ring
+ * buffer, so that its memory does not depend on the horizon. Time steps beyond the horizon have no availability.
+ */
+class RollingProfile {
+public:
+    // Constructor
+    RollingProfile(const Problem& problem, int size);
+    // Destructor
+    ~RollingProfile();
+
+    /**
+     * Resets the remaining availabilities to the capacities, for the window that starts at the given time step.
+     */
+    void start(int begin);
+
+    /**
+     * Moves the window forward to start at the given time step. The availabilities of the time steps that remain in
+     * the window are kept, the time steps that enter the window start at the capacities.
+     */
+    void advance(int begin);
+
+    /**
+     * Copies the window and the remaining availabilities of another profile of the same size.
+     */
+    void copy(const RollingProfile& other);
+
+    /**
+     * @return the first time step of the window
+     */
+    int begin() const { return first; }
+
+    /**
+     * @return the time step after the last time step of the window
+     */
+    int end() const { return first + size; }
+
+    /**
+     * Finds the earliest finish time at or after the given time at which the activity fits in the remaining
+     * availabilities, starting no earlier than the window.
+     *
+     * @param job the activity to place
+     * @param finish the earliest finish time to consider
+     * @return the earliest feasible finish time, or a value larger than the end of the window if there is none
+     */
+    int earliestFinish(int job, int finish) const;
+
+    /**
+     * Subtracts the requests of the activity from the remaining availabilities (it must be within the window).
+     *
+     * @param job the activity to place
+     * @param finish the finish time of the activity
+     */
+    void place(int job, int finish);
+
+private:
+    const Problem& problem;
+    const int size;       // Number of time steps in the window
+    int first;            // First time step of the window
+    int** availabilities; // Remaining availability per time step modulo size, per resource
+};
+}
+
+#endif //RCPSPT_HEURISTIC_PROFILE_H
@@ -0,0 +1,172 @@
+/************************************************************************************[ResultFile.cc]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "ResultFile.h"
+
+using namespace RcpsptHeuristic;
+
+/**
+ * @return the size of a name with its padding to a multiple of 4 bytes
+ */
+static uint64_t paddedLength(uint64_t nameLength) {
+    return (nameLength + 3) & ~(uint64_t)3;
+}
+
+ResultWriter::ResultWriter(const std::string& path)
+    : fd(open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)),
+      buffer(BUFFER_SIZE),
+      used(0),
+      offset(0),
+      failed(false) {
+    ResultHeader header = {}; // Without the magic number until the file is complete
+    write(&header, sizeof(header));
+}
+
+ResultWriter::~ResultWriter() {
+    close();
+}
+
+bool ResultWriter::add(std::string_view name, ResultStatus status, long milis, const int* schedule, int njobs) {
+    if (!isOpen()) return false;
+    ResultIndexEntry entry = {};
+    entry.offset = offset + used;
+    entry.nameLength = (uint32_t)name.size();
+    entry.njobs = schedule != nullptr ? njobs : 0;
+    entry.status = (int32_t)status;
+    entry.makespan = schedule != nullptr ? schedule[njobs - 1] : -1;
+    entry.milis = milis;
+    index.push_back(entry);
+
+    static const char padding[4] = {};
+    write(name.data(), name.size());
+    write(padding, paddedLength(name.size()) - name.size());
+    static_assert(sizeof(int) == sizeof(int32_t), "schedules are written as 32-bit integers");
+    if (schedule != nullptr) write(schedule, (size_t)njobs * sizeof(int32_t));
+    return isOpen();
+}
+
+bool ResultWriter::close() {
+    if (fd < 0) return false;
+    ResultHeader header = {};
+    header.magic = RESULT_MAGIC;
+    header.version = RESULT_VERSION;
+    header.nrecords = index.size();
+
+    // Align the index, so that the reader can use its entries in place
+    static const char padding[alignof(ResultIndexEntry)] = {};
+    uint64_t end = offset + used;
+    uint64_t misalignment = end % alignof(ResultIndexEntry);
+    if (misalignment != 0) write(padding, alignof(ResultIndexEntry) - misalignment);
+    header.indexOffset = offset + used;
+    write(index.data(), index.size() * sizeof(ResultIndexEntry));
+    flush();
+    if (!failed && pwrite(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)) failed = true;
+    if (::close(fd) != 0) failed = true;
+    fd = -1;
+    return !failed;
+}
+
+bool ResultWriter::write(const void* data, size_t size) {
+    const char* bytes = (const char*)data;
+    while (size > 0) {
+        if (used == buffer.size() && !flush()) return false;
+        size_t n = std::min(size, buffer.size() - used);
+        memcpy(buffer.data() + used, bytes, n);
+        used += n;
+        bytes += n;
+        size -= n;
+    }
+    return true;
+}
+
+bool ResultWriter::flush() {
+    if (fd < 0 || failed) return false;
+    for (size_t written = 0; written < used;) {
+        ssize_t n = ::write(fd, buffer.data() + written, used - written);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            failed = true;
+            return false;
+        }
+        written += (size_t)n;
+    }
+    offset += used;
+    used = 0;
+    return true;
+}
+
+ResultReader::ResultReader(const std::string& path)
+    : data(nullptr),
+      length(0),
+      index(nullptr),
+      nrecords(0) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return;
+    struct stat status;
+    if (fstat(fd, &status) == 0 && (size_t)status.st_size >= sizeof(ResultHeader)) {
+        void* mapped = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+            data = (const char*)mapped;
+            length = (size_t)status.st_size;
+        }
+    }
+    close(fd);
+    if (data == nullptr) return;
+
+    // Check the header, and that all records lie between the header and the index
+    const ResultHeader& header = *(const ResultHeader*)data;
+    if (header.magic != RESULT_MAGIC || header.version != RESULT_VERSION) return;
+    if (header.indexOffset < sizeof(ResultHeader) || header.indexOffset > length ||
+        header.nrecords > (length - header.indexOffset) / sizeof(ResultIndexEntry) ||
+        header.indexOffset % alignof(ResultIndexEntry) != 0) return;
+    const ResultIndexEntry* entries = (const ResultIndexEntry*)(data + header.indexOffset);
+    for (uint64_t i = 0; i < header.nrecords; i++) {
+        const ResultIndexEntry& entry = entries[i];
+        if (entry.njobs < 0 || entry.offset < sizeof(ResultHeader) || entry.offset % 4 != 0 ||
+            entry.offset > header.indexOffset ||
+            paddedLength(entry.nameLength) + (uint64_t)entry.njobs * sizeof(int32_t) >
+                header.indexOffset - entry.offset) return;
+    }
+    index = entries;
+    nrecords = (size_t)header.nrecords;
+}
+
+ResultReader::~ResultReader() {
+    if (data != nullptr) munmap((void*)data, length);
+}
+
+ResultRecord ResultReader::get(size_t i) const {
+    const ResultIndexEntry& entry = index[i];
+    const char* record = data + entry.offset;
+    const int32_t* schedule = entry.njobs > 0 ? (const int32_t*)(record + paddedLength(entry.nameLength)) : nullptr;
+    return {std::string_view(record, entry.nameLength), (ResultStatus)entry.status, entry.makespan, (long)entry.milis,
+            entry.njobs, schedule};
+}
@@ -0,0 +1,182 @@
+/*************************************************************************************[ResultFile.h]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+
+#ifndef RCPSPT_HEURISTIC_RESULTFILE_H
+#define RCPSPT_HEURISTIC_RESULTFILE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace RcpsptHeuristic {
+
+/*
+ * Binary result file (in native byte order, little endian on all supported platforms):
+ * - a header (ResultHeader);
+ * - the records: per instance its name, padded with zeros to a multiple of 4 bytes, followed by the end times of all
+ *   activities as 32-bit integers (none if no schedule was found);
+ * - zeros up to a multiple of 8 bytes, followed by the index: an entry (ResultIndexEntry) per record, in the order in
+ *   which they were written.
+ * The header is written last, so a file of which the writer did not finish is rejected by the reader.
+ */
+
+#define RESULT_MAGIC 0x52504352 // "RCPR" in little endian
+#define RESULT_VERSION 1
+
+/**
+ * Outcome of solving an instance.
+ */
+enum class ResultStatus : int32_t {
+    Found = 0,      // A schedule was found
+    Infeasible = 1, // Preprocessing found the instance to be infeasible
+    NoSolution = 2  // No schedule was found
+};
+
+struct ResultHeader {
+    uint32_t magic;       // RESULT_MAGIC (0 while the file is written)
+    uint32_t version;     // RESULT_VERSION
+    uint64_t nrecords;    // Number of records
+    uint64_t indexOffset; // Offset of the index in bytes
+    uint64_t reserved;
+};
+
+struct ResultIndexEntry {
+    uint64_t offset;     // Offset of the record in bytes
+    uint32_t nameLength; // Length of the name in bytes (without padding)
+    int32_t njobs;       // Number of end times of the record
+    int32_t status;      // ResultStatus
+    int32_t makespan;    // Makespan, or -1 if no schedule was found
+    int64_t milis;       // Solve time in milliseconds
+};
+
+/**
+ * Record of a result file, pointing into the memory of the ResultReader.
+ */
+struct ResultRecord {
+    std::string_view name;   // Instance name
+    ResultStatus status;
+    int makespan;            // Makespan, or -1 if no schedule was found
+    long milis;              // Solve time in milliseconds
+    int njobs;               // Number of end times in schedule
+    const int32_t* schedule; // End times for all activities, or nullptr if no schedule was found
+};
+
+/**
+ * Writes a result file through a buffer, appending records in the order in which they are added.
+ */
+class ResultWriter {
+public:
+    /**
+     * Creates or truncates the file.
+     *
+     * @param path the file to write
+     */
+    explicit ResultWriter(const std::string& path);
+
+    /**
+     * Finishes the file if close() was not called.
+     */
+    ~ResultWriter();
+
+    /**
+     * @return whether the file was created and no write failed
+     */
+    bool isOpen() const { return fd >= 0 && !failed; }
+
+    /**
+     * Appends a record.
+     *
+     * @param name the instance name
+     * @param status the outcome of the solve
+     * @param milis the solve time in milliseconds
+     * @param schedule the end times for all activities, or nullptr if no schedule was found
+     * @param njobs the number of activities
+     * @return false if writing failed
+     */
+    bool add(std::string_view name, ResultStatus status, long milis, const int* schedule, int njobs);
+
+    /**
+     * Writes the index and the header, and closes the file.
+     *
+     * @return false if writing failed
+     */
+    bool close();
+
+private:
+    bool write(const void* data, size_t size);
+    bool flush();
+
+    static constexpr size_t BUFFER_SIZE = 1 << 20;
+
+    int fd;
+    std::vector<char> buffer;
+    size_t used;     // Number of bytes in the buffer
+    uint64_t offset; // Offset in the file of the end of the buffer
+    std::vector<ResultIndexEntry> index;
+    bool failed;
+};
+
+/**
+ * Reads a result file by mapping it into memory: records are returned without copying.
+ */
+class ResultReader {
+public:
+    /**
+     * Maps the file and checks its header and index.
+     *
+     * @param path the file to read
+     */
+    explicit ResultReader(const std::string& path);
+
+    ~ResultReader();
+
+    ResultReader(const ResultReader&) = delete;
+    ResultReader& operator=(const ResultReader&) = delete;
+
+    /**
+     * @return whether the file was mapped and is a complete, valid result file
+     */
+    bool isOpen() const { return index != nullptr; }
+
+    /**
+     * @return the number of records
+     */
+    size_t size() const { return nrecords; }
+
+    /**
+     * @param i the index of the record (less than size())
+     * @return the record, valid as long as the reader exists
+     */
+    ResultRecord get(size_t i) const;
+
+private:
+    const char* data;
+    size_t length;
+    const ResultIndexEntry* index;
+    size_t nrecords;
+};
+}
+
+#endif //RCPSPT_HEURISTIC_RESULTFILE_H
@@ -0,0 +1,94 @@
+/********************************************************************************[SolutionStore.cc]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+
+#include "SolutionStore.h"
+
+using namespace RcpsptHeuristic;
+
+SolutionStore::SolutionStore(const std::string& path)
+    : path(path) {
+    std::ifstream input(path);
+    if (!input) return; // Nothing stored yet
+
+    std::string line;
+    while (std::getline(input, line)) {
+        if (line.empty()) continue;
+        std::istringstream record(line);
+        uint64_t fingerprint;
+        int njobs;
+        StoredSolution solution;
+        record >> std::hex >> fingerprint >> std::dec >> solution.makespan >> solution.lowerBound >> solution.config >> njobs;
+        if (!record || njobs < 0) continue; // Skip incomplete records, e.g. from an interrupted write
+        solution.schedule.resize(njobs);
+        for (int i = 0; i < njobs; i++) record >> solution.schedule[i];
+        if (!record) continue;
+        merge(fingerprint, solution);
+    }
+}
+
+bool SolutionStore::lookup(uint64_t fingerprint, StoredSolution& out) const {
+    auto it = best.find(fingerprint);
+    if (it == best.end()) return false;
+    out = it->second;
+    return true;
+}
+
+bool SolutionStore::record(uint64_t fingerprint, const StoredSolution& solution) {
+    if (!merge(fingerprint, solution)) return false;
+
+    std::ofstream output(path, std::ios::app);
+    if (!output) {
+        std::cerr << "Can't append to solution store: " << path << std::endl;
+        return false;
+    }
+    output << std::hex << fingerprint << std::dec << ' ' << solution.makespan << ' ' << solution.lowerBound << ' '
+           << solution.config << ' ' << solution.schedule.size();
+    for (int end : solution.schedule) output << ' ' << end;
+    output << std::endl;
+    return true;
+}
+
+bool SolutionStore::merge(uint64_t fingerprint, const StoredSolution& solution) {
+    auto it = best.find(fingerprint);
+    if (it == best.end()) {
+        best[fingerprint] = solution;
+        return true;
+    }
+
+    StoredSolution& stored = it->second;
+    bool improved = false;
+    if (solution.makespan < stored.makespan) {
+        stored.makespan = solution.makespan;
+        stored.config = solution.config;
+        stored.schedule = solution.schedule;
+        improved = true;
+    }
+    if (solution.lowerBound > stored.lowerBound) {
+        stored.lowerBound = solution.lowerBound;
+        improved = true;
+    }
+    return improved;
+}
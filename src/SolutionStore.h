@@ -0,0 +1,84 @@
+/*********************************************************************************[SolutionStore.h]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+#ifndef RCPSPT_HEURISTIC_SOLUTIONSTORE_H
+#define RCPSPT_HEURISTIC_SOLUTIONSTORE_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+namespace RcpsptHeuristic {
+
+/**
+ * Best known solution for a problem instance, as kept in a SolutionStore.
+ */
+struct StoredSolution {
+    int makespan;              // Makespan of the schedule
+    int lowerBound;            // Best known lower bound on the makespan
+    std::string config;        // Solver configuration that found the schedule
+    std::vector<int> schedule; // End times for all activities
+};
+
+/**
+ * Persistent store of the best known solution per problem instance, keyed by the fingerprint of the instance
+ * (see Problem::fingerprint()). The store is an append-only text file with one record per line:
+ * "[fingerprint] [makespan] [lower bound] [config] [njobs] [end time of each job]".
+ * When loading, records for the same fingerprint are merged (lowest makespan, highest lower bound).
+ */
+class SolutionStore {
+public:
+    /**
+     * Opens the store, loading all records from the given file if it exists.
+     *
+     * @param path file path of the store
+     */
+    explicit SolutionStore(const std::string& path);
+
+    /**
+     * Looks up the best known solution for an instance.
+     *
+     * @param fingerprint fingerprint of the instance
+     * @param out to which the stored solution will be written
+     * @return true if a solution was found, false otherwise
+     */
+    bool lookup(uint64_t fingerprint, StoredSolution& out) const;
+
+    /**
+     * Appends a solution to the store, if it improves the makespan or lower bound that is known for the instance.
+     *
+     * @param fingerprint fingerprint of the instance
+     * @param solution the solution to record
+     * @return true if the solution was appended, false otherwise
+     */
+    bool record(uint64_t fingerprint, const StoredSolution& solution);
+
+private:
+    bool merge(uint64_t fingerprint, const StoredSolution& solution);
+
+    std::string path;
+    std::unordered_map<uint64_t, StoredSolution> best;
+};
+}
+
+#endif //RCPSPT_HEURISTIC_SOLUTIONSTORE_H
@@ -23,14 +23,24 @@ SOFTWARE.
 #include <iostream>
 #include <queue>
 #include <random>
-#include <limits>
+#include <algorithm>
+#include <thread>
+#include <condition_variable>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
 
 #include "Solver.h"
+#include "Metrics.h"
 
 #define NPASSES 1000
+#define RELINK_POOL 8 // Size of the elite pool for path relinking if none was set
 #define TOURN_FACTOR 0.5
 #define OMEGA1 0.4
 #define OMEGA2 0.6
+#define PARALLEL_LEVEL_WIDTH 64 // Minimum number of jobs in a level of the precedence graph to process it in parallel
+#define CAPACITY_CHUNK 4096     // Number of time steps of which the capacities are summed at a time in preprocessing
 
 using namespace RcpsptHeuristic;
 
@@ -45,250 +55,1265 @@ bool Solver::solve(int* out, bool* infeasible) {
     return false;
 }
 
-bool PrSolver::solve(int* out, bool* infeasible) {
-    // This function is completely based on the tournament heuristic that is described by Hartmann (2013) (reference in README.md)
-    *infeasible = false;
+PrSolver::PrSolver(Problem& p)
+    : Solver(p),
+      ef(new int[p.njobs]()),
+      ls(new int[p.njobs]),
+      ru(new double[p.njobs]),
+      cpru(new double[p.njobs]),
+      rank(new int[p.njobs]),
+      byRank(new int[p.njobs]),
+      incumbent(nullptr),
+      weights(nullptr),
+      target(0),
+      npasses(NPASSES),
+      timeLimit(0),
+      cancelled(nullptr),
+      seed(0),
+      checkpointInterval(NPASSES),
+      nthreads(1),
+      layout(Layout::ResourceMajor),
+      decompose(false),
+      contract(false),
+      window(0),
+      lookahead(0),
+      eliteSize(0),
+      eliteDistance(-1),
+      relink(false),
+      preprocessed(false),
+      best(nullptr),
+      bestMakespan(INT32_MAX / 2),
+      nextPass(0),
+      passLimit(0),
+      stopMakespan(0),
+      fixedEnds(nullptr),
+      releases(nullptr),
+      nfixed(0),
+      passMilis(0),
+      passCount(0) {}
 
-    std::queue<int> q; // Use a queue for breadth-first traversal of the precedence graph
+PrSolver::~PrSolver() {
+    delete[] ef;
+    delete[] ls;
+    delete[] ru;
+    delete[] cpru;
+    delete[] rank;
+    delete[] byRank;
+    delete[] incumbent;
+    delete[] weights;
+}
 
-    // Calculate earliest feasible finish times, using the definition from Hartmann (2013) (reference in README.md)
+void PrSolver::setIncumbent(const int* schedule) {
+    if (incumbent == nullptr) incumbent = new int[problem.njobs];
+    for (int i = 0; i < problem.njobs; i++) incumbent[i] = schedule[i];
+}
 
-    int* ef = new int[problem.njobs](); // Earliest feasible finish times for all jobs
+void PrSolver::setPriorityWeights(const double* w) {
+    if (weights == nullptr) weights = new double[problem.njobs];
+    for (int i = 0; i < problem.njobs; i++) weights[i] = w[i];
+}
 
-    // Enqueue job 0
-    q.push(0);
+std::string PrSolver::getConfig() const {
+    std::string config = "pr:passes=" + std::to_string(npasses) + ",threads=" + std::to_string(nthreads);
+    if (layout == Layout::TimeMajor) config += ",layout=time-major";
+    if (decompose) config += ",decompose";
+    if (contract) config += ",contract";
+    if (window > 0) config += ",rolling=" + std::to_string(window) + ":" + std::to_string(lookahead);
+    if (weights != nullptr) config += ",weighted";
+    if (timeLimit > 0) config += ",time=" + std::to_string(timeLimit);
+    if (seed != 0) config += ",seed=" + std::to_string(seed);
+    if (eliteSize > 0) {
+        config += ",elite=" + std::to_string(eliteSize);
+        if (eliteDistance >= 0) config += ":" + std::to_string(eliteDistance);
+    }
+    if (relink) config += ",relink";
+    return config;
+}
 
-    while (!q.empty()) {
-        int job = q.front();
-        q.pop();
-        int duration = problem.durations[job];
+bool PrSolver::configure(const std::string& settings) {
+    size_t begin = settings.compare(0, 3, "pr:") == 0 ? 3 : 0;
+    while (begin < settings.size()) {
+        size_t end = settings.find(',', begin);
+        if (end == std::string::npos) end = settings.size();
+        std::string setting = settings.substr(begin, end - begin);
+        begin = end + 1;
+        if (setting.empty()) continue;
 
-        // Move finish until it is feasible considering resource constraints
-        bool feasibleFinal = false;
-        while (!feasibleFinal) {
-            bool feasible = true;
-            for (int k = 0; feasible && k < problem.nresources; k++) {
-                for (int t = duration - 1; feasible && t >= 0; t--) {
-                    if (problem.requests[job][k][t] > problem.capacities[k][ef[job] - duration + t]) {
-                        feasible = false;
-                        ef[job]++;
-                    }
-                }
+        size_t equals = setting.find('=');
+        std::string key = setting.substr(0, equals);
+        std::string value = equals != std::string::npos ? setting.substr(equals + 1) : "";
+        try {
+            if (key == "passes") setPasses(std::max(std::stoi(value), 0));
+            else if (key == "threads") setThreads(std::max(std::stoi(value), 1));
+            else if (key == "layout" && value == "time-major") setLayout(Layout::TimeMajor);
+            else if (key == "layout" && value == "resource-major") setLayout(Layout::ResourceMajor);
+            else if (key == "decompose") setDecompose(true);
+            else if (key == "contract") setContractChains(true);
+            else if (key == "relink") setPathRelinking(true);
+            else if (key == "rolling") {
+                size_t colon = value.find(':');
+                int w = std::max(std::stoi(value.substr(0, colon)), 0);
+                setRollingHorizon(w, colon != std::string::npos ? std::max(std::stoi(value.substr(colon + 1)), 0) : w);
             }
-            if (feasible) feasibleFinal = true;
-            if (ef[job] > problem.horizon) {
-                delete[] ef;
-                *infeasible = true;
-                return false;
+            else if (key == "time") setTimeLimit(std::max(std::stoi(value), 0));
+            else if (key == "seed") setSeed((unsigned)std::stoul(value));
+            else if (key == "elite") {
+                size_t colon = value.find(':');
+                setElitePool(std::max(std::stoi(value.substr(0, colon)), 0),
+                             colon != std::string::npos ? std::max(std::stol(value.substr(colon + 1)), 0L) : -1);
             }
+            else return false;
         }
-
-        // Update finish times, and enqueue successors
-        for (int i = 0; i < problem.nsuccessors[job]; i++) {
-            int successor = problem.successors[job][i];
-            int f = ef[job] + problem.durations[successor];
-            if (f > ef[successor]) ef[successor] = f; // Use maximum values, because we are interested in critical paths
-            q.push(successor); // Enqueue successor
+        catch (const std::exception&) { // Invalid number
+            return false;
         }
     }
+    return true;
+}
 
-    // Calculate latest feasible start times, again using the definition from Hartmann (2013) (reference in README.md)
+/**
+ * Reusable barrier for a fixed number of threads.
+ */
+class Barrier {
+public:
+    explicit Barrier(int n)
+        : n(n), waiting(0), generation(0) {}
 
-    int* ls = new int[problem.njobs];
-    for (int i = 0; i < problem.njobs; i++) ls[i] = problem.horizon;
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        int current = generation;
+        if (++waiting == n) {
+            waiting = 0;
+            generation++;
+            condition.notify_all();
+        }
+        else condition.wait(lock, [&]() { return generation != current; });
+    }
 
-    // Enqueue the sink job
-    q.push(problem.njobs - 1);
+private:
+    std::mutex mutex;
+    std::condition_variable condition;
+    int n, waiting, generation;
+};
 
+bool PrSolver::computeLevels() {
+    // Topological levels (Kahn's algorithm): the level of a job is one more than the highest level of its predecessors
+    std::vector<int> level(problem.njobs, 0);
+    std::vector<int> remaining(problem.njobs);
+    std::vector<int> count(1, 0);
+    std::queue<int> q;
+    for (int job = 0; job < problem.njobs; job++) {
+        remaining[job] = (int)problem.predecessors[job].size();
+        if (remaining[job] == 0) q.push(job);
+    }
+    int nsorted = 0;
     while (!q.empty()) {
         int job = q.front();
         q.pop();
-        int duration = problem.durations[job];
+        nsorted++;
+        if (level[job] + 1 >= (int)count.size()) count.resize(level[job] + 2, 0);
+        count[level[job] + 1]++;
+        for (int i = 0; i < problem.nsuccessors[job]; i++) {
+            int successor = problem.successors[job][i];
+            level[successor] = std::max(level[successor], level[job] + 1);
+            if (--remaining[successor] == 0) q.push(successor);
+        }
+    }
+    if (nsorted < problem.njobs) return false; // The precedence graph contains a cycle
 
-        // Move start until it is feasible considering resource constraints
-        bool feasibleFinal = false;
-        while (!feasibleFinal) {
-            bool feasible = true;
-            for (int k = 0; feasible && k < problem.nresources; k++) {
-                for (int t = 0; feasible && t < duration; t++) {
-                    if (problem.requests[job][k][t] > problem.capacities[k][ls[job] + t]) {
-                        feasible = false;
-                        ls[job]--;
-                    }
-                }
-            }
-            if (feasible) feasibleFinal = true;
-            if (ls[job] < 0) {
-                delete[] ef;
-                delete[] ls;
-                *infeasible = true;
-                return false;
+    // Order the jobs by level (and by index within a level)
+    for (int l = 1; l < (int)count.size(); l++) count[l] += count[l - 1];
+    levelStart = count;
+    levelOrder.assign(problem.njobs, 0);
+    for (int job = 0; job < problem.njobs; job++) levelOrder[count[level[job]]++] = job;
+    return true;
+}
+
+void PrSolver::forEachLevel(bool backwards, const std::function<void(int)>& process) {
+    int nlevels = (int)levelStart.size() - 1;
+    auto levelAt = [&](int i) { return backwards ? nlevels - 1 - i : i; };
+    auto width = [&](int l) { return levelStart[l + 1] - levelStart[l]; };
+    auto runLevel = [&](int l, int thread, int n) {
+        for (int i = levelStart[l] + thread; i < levelStart[l + 1]; i += n) process(levelOrder[i]);
+    };
+
+    if (nthreads <= 1) {
+        for (int i = 0; i < nlevels; i++) runLevel(levelAt(i), 0, 1);
+        return;
+    }
+
+    // Wide levels are divided over all threads, consecutive narrow levels are processed by the first thread only
+    Barrier barrier(nthreads);
+    auto work = [&](int thread) {
+        for (int i = 0; i < nlevels;) {
+            if (width(levelAt(i)) >= PARALLEL_LEVEL_WIDTH) runLevel(levelAt(i++), thread, nthreads);
+            else {
+                int j = i;
+                while (j < nlevels && width(levelAt(j)) < PARALLEL_LEVEL_WIDTH) j++;
+                if (thread == 0)
+                    for (int m = i; m < j; m++) runLevel(levelAt(m), 0, 1);
+                i = j;
             }
+            barrier.wait();
         }
+    };
+    std::vector<std::thread> threads;
+    for (int thread = 1; thread < nthreads; thread++) threads.emplace_back(work, thread);
+    work(0);
+    for (std::thread& thread : threads) thread.join();
+}
 
-        // Update start times, and enqueue predecessors
-        for (int predecessor : problem.predecessors[job]) {
-            int s = ls[job] - problem.durations[predecessor];
-            if (s < ls[predecessor]) ls[predecessor] = s; // Use minimum values for determining critical paths
-            q.push(predecessor); // Enqueue predecessor
+int PrSolver::shiftFinish(int job, int finish) const {
+    int duration = problem.durations[job];
+    for (; finish <= problem.horizon; finish++) {
+        bool feasible = true;
+        for (int i = 0; feasible && i < problem.nused[job]; i++) {
+            int k = problem.used[job][i];
+            for (int t = duration - 1; feasible && t >= 0; t--)
+                if (problem.requests[job][k][t] > problem.capacity(k, finish - duration + t)) feasible = false;
         }
+        if (feasible) break;
+    }
+    return finish;
+}
+
+int PrSolver::shiftStart(int job, int start) const {
+    int duration = problem.durations[job];
+    for (; start >= 0; start--) {
+        bool feasible = true;
+        for (int i = 0; feasible && i < problem.nused[job]; i++) {
+            int k = problem.used[job][i];
+            for (int t = 0; feasible && t < duration; t++)
+                if (problem.requests[job][k][t] > problem.capacity(k, start + t)) feasible = false;
+        }
+        if (feasible) break;
+    }
+    return start;
+}
+
+bool PrSolver::preprocess() {
+    // The preprocessing steps are based on the tournament heuristic that is described by Hartmann (2013) (reference in README.md)
+    // The precedence graph is traversed level by level, where the jobs within a level are independent and can be
+    // processed in parallel. A job is processed after all its predecessors (or successors, when traversing backwards),
+    // so it is processed once, with the same result as a breadth-first traversal that processes it repeatedly.
+    if (!computeLevels()) return false;
+    int sink = problem.njobs - 1;
+    std::atomic<bool> infeasible(false);
+
+    // Jobs that cannot be reached from the source (or cannot reach the sink) are not traversed
+    std::vector<char> fromSource(problem.njobs, 0), toSink(problem.njobs, 0);
+    for (int job : levelOrder) {
+        if (job == 0) fromSource[job] = 1;
+        for (int predecessor : problem.predecessors[job])
+            if (fromSource[predecessor]) fromSource[job] = 1;
     }
+    for (int i = problem.njobs - 1; i >= 0; i--) {
+        int job = levelOrder[i];
+        if (job == sink) toSink[job] = 1;
+        for (int j = 0; j < problem.nsuccessors[job]; j++)
+            if (toSink[problem.successors[job][j]]) toSink[job] = 1;
+    }
+
+    // Calculate earliest feasible finish times, using the definition from Hartmann (2013) (reference in README.md)
+
+    for (int i = 0; i < problem.njobs; i++) ef[i] = 0;
+    forEachLevel(false, [&](int job) {
+        if (!fromSource[job]) return;
+        // Use maximum values, because we are interested in critical paths
+        int finish = 0;
+        for (int predecessor : problem.predecessors[job])
+            if (fromSource[predecessor]) finish = std::max(finish, ef[predecessor] + problem.durations[job]);
+        // Move finish until it is feasible considering resource constraints
+        ef[job] = shiftFinish(job, finish);
+        if (ef[job] > problem.horizon) infeasible = true;
+    });
+    if (infeasible) return false;
+
+    // Calculate latest feasible start times, again using the definition from Hartmann (2013) (reference in README.md)
+
+    for (int i = 0; i < problem.njobs; i++) ls[i] = problem.horizon;
+    forEachLevel(true, [&](int job) {
+        if (!toSink[job]) return;
+        // Use minimum values for determining critical paths
+        int start = problem.horizon;
+        for (int i = 0; i < problem.nsuccessors[job]; i++) {
+            int successor = problem.successors[job][i];
+            if (toSink[successor]) start = std::min(start, ls[successor] - problem.durations[job]);
+        }
+        // Move start until it is feasible considering resource constraints
+        ls[job] = shiftStart(job, start);
+        if (ls[job] < 0) infeasible = true;
+    });
+    if (infeasible) return false;
 
     // Check if any time window is too small: lf[i]-es[i]<durations[i]
     // using the definition from Hartmann (2013) (reference in README.md)
     for (int i = 0; i < problem.njobs; i++) {
-        if ((ls[i] + problem.durations[i]) - (ef[i] - problem.durations[i]) < problem.durations[i]) {
-            delete[] ef;
-            delete[] ls;
-            *infeasible = true;
-            return false;
-        }
+        if ((ls[i] + problem.durations[i]) - (ef[i] - problem.durations[i]) < problem.durations[i]) return false;
     }
 
     // Calculate extended resource utilization values, using the definition from Hartmann (2013) (reference in README.md)
 
-    double* ru = new double[problem.njobs];
-
-    // Enqueue the sink job
-    q.push(problem.njobs - 1);
+    // Capacity over all resources before the start (2 * job) and before the end (2 * job + 1) of the time window of
+    // each job, for its availability. The capacities are summed chunk by chunk in a sweep over the bounds of the
+    // windows, so that preprocessing allocates no memory over the whole horizon (nor does the rolling-horizon mode)
+    std::vector<std::pair<int, int>> bounds;
+    for (int job = 0; job < problem.njobs; job++) {
+        if (!toSink[job]) continue;
+        bounds.emplace_back(ef[job] - problem.durations[job], 2 * job);
+        bounds.emplace_back(ls[job] + problem.durations[job], 2 * job + 1);
+    }
+    std::sort(bounds.begin(), bounds.end());
+    std::vector<long> totalCapacity(2 * problem.njobs, 0);
+    std::vector<int> capacities(CAPACITY_CHUNK);
+    std::vector<long> stepCapacity(CAPACITY_CHUNK);
+    long total = 0;
+    size_t next = 0;
+    for (int from = 0; from < problem.horizon && next < bounds.size(); from += CAPACITY_CHUNK) {
+        int to = std::min(from + CAPACITY_CHUNK, problem.horizon);
+        std::fill(stepCapacity.begin(), stepCapacity.end(), 0);
+        for (int k = 0; k < problem.nresources; k++) {
+            problem.fillCapacities(k, from, to, capacities.data());
+            for (int t = from; t < to; t++) stepCapacity[t - from] += capacities[t - from];
+        }
+        for (int t = from; t < to; t++) {
+            for (; next < bounds.size() && bounds[next].first == t; next++) totalCapacity[bounds[next].second] = total;
+            total += stepCapacity[t - from];
+        }
+    }
+    for (; next < bounds.size(); next++) totalCapacity[bounds[next].second] = total; // Windows that end at the horizon
 
-    while (!q.empty()) {
-        int job = q.front();
-        q.pop();
+    for (int i = 0; i < problem.njobs; i++) ru[i] = 0.0;
+    forEachLevel(true, [&](int job) {
+        if (!toSink[job]) return;
         int duration = problem.durations[job];
 
-        int demand = 0, availability = 0;
-        for (int k = 0; k < problem.nresources; k++) {
+        int demand = 0;
+        for (int i = 0; i < problem.nused[job]; i++) {
+            int k = problem.used[job][i];
             for (int t = 0; t < duration; t++)
                 demand += problem.requests[job][k][t];
-            for (int t = ef[job] - duration; t < ls[job] + duration; t++) // Use the time window from earliest start to latest finish
-                availability += problem.capacities[k][t];
         }
+        // Use the time window from earliest start to latest finish
+        int availability = (int)(totalCapacity[2 * job + 1] - totalCapacity[2 * job]);
 
-
-        ru[job] = OMEGA1 * (((double) problem.nsuccessors[job] / (double) problem.nresources) *
-                            ((double) demand / (double) availability));
-        for (int successor = 0; successor < problem.nsuccessors[job]; successor++)
-            ru[job] += OMEGA2 * ru[successor];
-        if (std::isnan(ru[job]) || ru[job] < 0.0) ru[job] = 0.0; // Prevent errors from strange values here
-
-        // Enqueue predecessors
-        for (int predecessor : problem.predecessors[job])
-            q.push(predecessor);
-    }
+        double value = OMEGA1 * (((double) problem.nsuccessors[job] / (double) problem.nresources) *
+                                 ((double) demand / (double) availability));
+        for (int i = 0; i < problem.nsuccessors[job]; i++)
+            value += OMEGA2 * ru[problem.successors[job][i]];
+        if (std::isnan(value) || value < 0.0) value = 0.0; // Prevent errors from strange values here
+        ru[job] = value;
+    });
 
     // Calculate the CPRU (critical path and resource utilization) priority value for each activity, using the definition from Hartmann (2013) (reference in README.md)
-    double* cpru = new double[problem.njobs];
     for (int job = 0; job < problem.njobs; job++) {
         int cp = problem.horizon - ls[job]; // Critical path length
         cpru[job] = cp * ru[job];
+        if (weights != nullptr) cpru[job] *= weights[job];
+    }
+
+    // Convert the priority values into dense integer ranks (0 is the best priority), breaking ties by job index, so
+    // that tournaments only compare integers and their results do not depend on floating-point details
+    for (int job = 0; job < problem.njobs; job++) byRank[job] = job;
+    std::stable_sort(byRank, byRank + problem.njobs, [this](int a, int b) { return cpru[a] > cpru[b]; });
+    for (int r = 0; r < problem.njobs; r++) rank[byRank[r]] = r;
+
+    return true;
+}
+
+/**
+ * Buffers and random number generator of a thread that runs passes.
+ */
+struct PrSolver::Worker {
+    Worker(const Problem& problem, const ProfileSummary& summary, unsigned seed)
+        : profile(problem, summary),
+          eligible(new int[problem.njobs]),
+          selected(new int[problem.njobs]),
+          schedule(new int[problem.njobs]),
+          eng(seed),
+          distribution(0, 1) {}
+
+    ~Worker() {
+        delete[] eligible;
+        delete[] selected;
+        delete[] schedule;
+    }
+
+    ResourceProfile profile; // Remaining resource availabilities
+    int* eligible;   // Eligible activities
+    int* selected;   // Activities that were randomly selected for the tournament
+    int* schedule;   // End times for all activities in the current pass
+    std::default_random_engine eng;
+    std::uniform_real_distribution<double> distribution;
+};
+
+bool PrSolver::solve(int* out, bool* infeasible) {
+    if (checkpointPath.empty()) {
+        if (begin(out, infeasible)) {
+            // A resumed single-threaded solve continues with the random engine of the checkpoint
+            if (stepWorker != nullptr && nthreads <= 1) step(npasses);
+            else runWorkers(*summary);
+        }
+        return finish();
     }
 
-    std::random_device rd;
-    std::default_random_engine eng(rd());
-    std::uniform_real_distribution<double> distribution(0, 1);
+    loadCheckpoint(checkpointPath);
+    if (begin(out, infeasible)) {
+        while (step(checkpointInterval)) saveCheckpoint(checkpointPath);
+    }
+    std::remove(checkpointPath.c_str());
+    return finish();
+}
+
+bool PrSolver::begin(int* out, bool* infeasible) {
+    // This function is completely based on the tournament heuristic that is described by Hartmann (2013) (reference in README.md)
+    startTime = std::chrono::steady_clock::now();
+    deadline = timeLimit > 0 ? startTime + std::chrono::milliseconds(timeLimit)
+                             : std::chrono::steady_clock::time_point::max();
+    trajectory.clear();
+    bestMakespan = INT32_MAX / 2;
+    best = out;
+    passMilis = 0;
+    passCount = 0;
+    elite.reset(eliteSize > 0 ? eliteSize : relink ? RELINK_POOL : 0, eliteDistance >= 0 ? eliteDistance : problem.njobs,
+                problem.njobs);
+    preprocessed = preprocess();
+    std::chrono::duration<double, std::milli> preprocessTime = std::chrono::steady_clock::now() - startTime;
+    Metrics::observe(Phase::Preprocess, preprocessTime.count());
+    *infeasible = !preprocessed;
+    if (!preprocessed) return false;
+
+    if (incumbent != nullptr && incumbent[problem.njobs - 1] <= problem.horizon) improve(incumbent);
+
+    if (decompose) {
+        std::vector<std::vector<int>> clusters = findClusters();
+        if (clusters.size() > 1) {
+            solveClusters(clusters);
+            return false;
+        }
+    }
+
+    int contractedPasses = contract ? solveContracted() : 0;
+
+    if (window > 0) {
+        solveRolling();
+        return false;
+    }
 
     // Run a set number of passes ('tournaments'), as described by Hartmann (2013) (reference in README.md)
+    stopMakespan = std::max(getLowerBound(), target);
+    nextPass = contractedPasses;
+    passLimit = npasses;
+    summary.reset(new ProfileSummary(problem, layout));
+    if (resumed != nullptr) {
+        resume(*resumed);
+        resumed.reset();
+    }
+    return passesRemain();
+}
 
-    int** available = new int*[problem.nresources];
-    for (int k = 0; k < problem.nresources; k++)
-        available[k] = new int[problem.horizon];
-    int* eligible = new int[problem.njobs];
-    int* selected = new int[problem.njobs];
-    int neligible, nselected;
-    int* schedule = new int[problem.njobs];
-    int bestMakespan = INT32_MAX / 2;
-    for (int pass = 0; pass < NPASSES; pass++) {
-        for (int i = 0; i < problem.njobs; i++) schedule[i] = -1;
+bool PrSolver::step(int n) {
+    if (summary == nullptr) return false;
+    if (stepWorker == nullptr) stepWorker.reset(new Worker(problem, *summary, workerSeed(0)));
+    passLimit = n < npasses - nextPass ? nextPass + n : npasses;
+    std::chrono::steady_clock::time_point stepStart = std::chrono::steady_clock::now();
+    runPasses(*stepWorker);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - stepStart;
+    passMilis += elapsed.count();
+    if (nextPass > passLimit) nextPass = passLimit; // The last check of the loop counts as a pass
+    return passesRemain();
+}
+
+bool PrSolver::finish() {
+    if (summary != nullptr && relink) {
+        std::chrono::steady_clock::time_point relinkStart = std::chrono::steady_clock::now();
+        relinkElite();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - relinkStart;
+        passMilis += elapsed.count();
+    }
+    if (summary != nullptr) Metrics::observe(Phase::Passes, passMilis);
+    stepWorker.reset();
+    summary.reset();
+    best = nullptr;
+    return bestMakespan <= problem.horizon;
+}
 
-        // Initialize remaining resource availabilities
-        for (int k = 0; k < problem.nresources; k++)
+bool PrSolver::repair(const int* schedule, int now, const bool* started, const Disruption& disruption, int budget,
+                      int* out, std::vector<std::pair<int, int>>* overloads) {
+    startTime = std::chrono::steady_clock::now();
+    deadline = startTime + std::chrono::milliseconds(budget);
+    trajectory.clear();
+    bestMakespan = INT32_MAX / 2;
+    best = out;
+    elite.reset(eliteSize, eliteDistance >= 0 ? eliteDistance : problem.njobs, problem.njobs);
+
+    // Apply the capacity drop
+    if (disruption.resource >= 0) {
+        int k = disruption.resource;
+        for (int t = std::max(disruption.from, 0); t < std::min(disruption.to, problem.horizon); t++)
+            problem.setCapacity(k, t, std::max(problem.capacity(k, t) - disruption.amount, 0));
+    }
+
+    // Keep the started activities, the others cannot start before the current time (or the release of the delayed one)
+    int sink = problem.njobs - 1;
+    fixedEnds = new int[problem.njobs];
+    releases = new int[problem.njobs];
+    nfixed = 0;
+    std::vector<int> order;
+    for (int job = 1; job < problem.njobs; job++) {
+        bool fixed = started != nullptr ? started[job] : schedule[job] - problem.durations[job] < now;
+        if (fixed && job != sink) {
+            fixedEnds[job] = schedule[job];
+            nfixed++;
+        }
+        else {
+            fixedEnds[job] = -1;
+            order.push_back(job);
+        }
+        releases[job] = job == disruption.job ? std::max(now, disruption.release) : now;
+    }
+    fixedEnds[0] = 0;
+    releases[0] = 0;
+
+    // The started activities cannot move out of the capacity drop, so report the time steps that they overload
+    if (overloads != nullptr) {
+        overloads->clear();
+        std::vector<int> demand(problem.horizon);
+        for (int k = 0; k < problem.nresources; k++) {
+            std::fill(demand.begin(), demand.end(), 0);
+            for (int job = 1; job < problem.njobs; job++) {
+                if (fixedEnds[job] < 0 || problem.requests[job][k] == nullptr) continue;
+                int start = fixedEnds[job] - problem.durations[job];
+                for (int t = std::max(start, 0); t < std::min(fixedEnds[job], problem.horizon); t++)
+                    demand[t] += problem.requests[job][k][t - start];
+            }
             for (int t = 0; t < problem.horizon; t++)
-                available[k][t] = problem.capacities[k][t];
+                if (demand[t] > problem.capacity(k, t)) overloads->emplace_back(k, t);
+        }
+    }
 
-        // Schedule the starting dummy activity
-        schedule[0] = 0;
+    // Priority values are only calculated once, a failure is not fatal because the current schedule provides an order
+    if (!preprocessed) preprocessed = preprocess();
+    if (levelOrder.empty() && !computeLevels()) {
+        delete[] fixedEnds;
+        delete[] releases;
+        fixedEnds = releases = nullptr;
+        best = nullptr;
+        return false;
+    }
+    std::vector<int> position(problem.njobs);
+    for (int i = 0; i < problem.njobs; i++) position[levelOrder[i]] = i;
+    if (!preprocessed) {
+        for (int job = 0; job < problem.njobs; job++) byRank[job] = job;
+        std::sort(byRank, byRank + problem.njobs, [&](int a, int b) {
+            int startA = schedule[a] - problem.durations[a], startB = schedule[b] - problem.durations[b];
+            return startA != startB ? startA < startB : position[a] < position[b];
+        });
+        for (int r = 0; r < problem.njobs; r++) rank[byRank[r]] = r;
+    }
 
-        // Schedule all remaining jobs
-        for (int i = 1; i < problem.njobs; i++) {
-            // Randomly select a fraction of the eligible activities (with replacement)
-            neligible = 0;
-            for (int j = 1; j < problem.njobs; j++) {
-                if (schedule[j] < 0) {
-                    bool predecessorsScheduled = true;
-                    for (int predecessor : problem.predecessors[j])
-                        if (schedule[predecessor] < 0) predecessorsScheduled = false;
-                    if (predecessorsScheduled) eligible[neligible++] = j;
-                }
+    // Right-shift: place the activities as early as possible in the order of their current start times (ties are
+    // broken by topological level, so that each activity is placed after its predecessors)
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        int startA = schedule[a] - problem.durations[a], startB = schedule[b] - problem.durations[b];
+        return startA != startB ? startA < startB : position[a] < position[b];
+    });
+    ProfileSummary summary(problem, layout);
+    Worker worker(problem, summary, workerSeed(0));
+    startPass(worker);
+    bool placed = true;
+    for (int i = 0; placed && i < (int)order.size(); i++) {
+        int job = order[i];
+        for (int predecessor : problem.predecessors[job])
+            if (worker.schedule[predecessor] < 0) placed = false;
+        if (placed) {
+            int finish = placeEarliest(worker, job);
+            if (finish > problem.horizon) placed = false;
+        }
+    }
+    if (placed) improve(worker.schedule);
+
+    // Re-sample the order of the activities that were not started, until the budget is spent
+    stopMakespan = std::max(now, target);
+    for (int job = 1; job < problem.njobs; job++) stopMakespan = std::max(stopMakespan, fixedEnds[job]);
+    nextPass = 0;
+    passLimit = npasses;
+    passMilis = 0;
+    passCount = 0;
+    if (budget > 0) {
+        runWorkers(summary);
+        Metrics::observe(Phase::Passes, passMilis);
+    }
+
+    delete[] fixedEnds;
+    delete[] releases;
+    fixedEnds = releases = nullptr;
+    nfixed = 0;
+    best = nullptr;
+    return bestMakespan <= problem.horizon;
+}
+
+std::vector<std::vector<int>> PrSolver::findClusters() const {
+    // Union-find over the non-dummy activities and the resources: each activity is joined with its successors and
+    // with the resources it uses, so that each set is a group of components that (transitively) share resources
+    int sink = problem.njobs - 1;
+    std::vector<int> parent(problem.njobs + problem.nresources);
+    for (int i = 0; i < (int)parent.size(); i++) parent[i] = i;
+    auto find = [&](int x) {
+        while (parent[x] != x) x = parent[x] = parent[parent[x]];
+        return x;
+    };
+    for (int job = 1; job < sink; job++) {
+        for (int i = 0; i < problem.nsuccessors[job]; i++)
+            if (problem.successors[job][i] != sink) parent[find(job)] = find(problem.successors[job][i]);
+        for (int i = 0; i < problem.nused[job]; i++) parent[find(job)] = find(problem.njobs + problem.used[job][i]);
+    }
+
+    std::vector<int> clusterIndex(parent.size(), -1);
+    std::vector<std::vector<int>> clusters;
+    for (int job = 1; job < sink; job++) {
+        int root = find(job);
+        if (clusterIndex[root] < 0) {
+            clusterIndex[root] = (int)clusters.size();
+            clusters.emplace_back();
+        }
+        clusters[clusterIndex[root]].push_back(job);
+    }
+    return clusters;
+}
+
+void PrSolver::solveClusters(const std::vector<std::vector<int>>& clusters) {
+    int sink = problem.njobs - 1;
+    int nclusters = (int)clusters.size();
+
+    // Solve the largest clusters first, for a better balance between the threads
+    std::vector<int> order(nclusters);
+    for (int c = 0; c < nclusters; c++) order[c] = c;
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return clusters[a].size() > clusters[b].size(); });
+
+    // The clusters share the time limit, each one gets the time that remains when it starts
+    std::chrono::steady_clock::time_point due = startTime + std::chrono::milliseconds(timeLimit);
+
+    int* schedule = new int[problem.njobs];
+    std::atomic<int> next(0);
+    std::atomic<bool> failed(false);
+    auto work = [&](int threads) {
+        for (int c = next++; c < nclusters && !failed; c = next++) {
+            const std::vector<int>& cluster = clusters[order[c]];
+
+            // Restrict the problem to the cluster, with the dummy activities and the resources it uses
+            std::vector<int> jobs(1, 0);
+            jobs.insert(jobs.end(), cluster.begin(), cluster.end());
+            jobs.push_back(sink);
+            std::vector<char> isUsed(problem.nresources, 0);
+            for (int job : cluster)
+                for (int i = 0; i < problem.nused[job]; i++) isUsed[problem.used[job][i]] = 1;
+            std::vector<int> resources;
+            for (int k = 0; k < problem.nresources; k++)
+                if (isUsed[k]) resources.push_back(k);
+            Problem* subproblem = problem.subproblem(jobs, resources);
+            int n = subproblem->njobs;
+
+            PrSolver solver(*subproblem);
+            solver.setPasses(npasses);
+            solver.setThreads(threads);
+            solver.setLayout(layout);
+            solver.setRollingHorizon(window, lookahead);
+            solver.setContractChains(contract);
+            if (timeLimit > 0) {
+                std::chrono::duration<double, std::milli> remaining = due - std::chrono::steady_clock::now();
+                solver.setTimeLimit(std::max((int)remaining.count(), 1));
             }
-            int Z = std::max((int)(TOURN_FACTOR * neligible), 2);
-            nselected = 0;
-            for (int j = 0; j < Z; j++) {
-                int choice = (int)(distribution(eng) * neligible);
-                selected[nselected++] = eligible[choice];
+            solver.setCancelToken(cancelled);
+            solver.setSeed(seed);
+            solver.setTarget(target);
+            if (weights != nullptr) {
+                std::vector<double> subweights(n);
+                for (int i = 0; i < n; i++) subweights[i] = weights[jobs[i]];
+                solver.setPriorityWeights(subweights.data());
             }
-
-            // Select the activity with the best priority value
-            int winner = -1;
-            double bestPriority = -std::numeric_limits<double>::max()/2.0;
-            for (int j = 0; j < nselected; j++) {
-                int sjob = selected[j];
-                if (cpru[sjob] >= bestPriority) {
-                    bestPriority = cpru[sjob];
-                    winner = sjob;
-                }
+            int* result = new int[n];
+            if (incumbent != nullptr) {
+                for (int i = 0; i < n - 1; i++) result[i] = incumbent[jobs[i]];
+                result[n - 1] = 0;
+                for (int i = 0; i < n - 1; i++) result[n - 1] = std::max(result[n - 1], result[i]);
+                solver.setIncumbent(result);
+            }
+            bool infeasible;
+            if (solver.solve(result, &infeasible)) {
+                for (int i = 1; i < n - 1; i++) schedule[jobs[i]] = result[i];
             }
+            else failed = true;
+
+            delete[] result;
+            delete subproblem;
+        }
+    };
 
-            // Schedule it as early as possible
-            int finish = -1;
-            for (int predecessor : problem.predecessors[winner]) {
-                int newFinish = schedule[predecessor] + problem.durations[winner];
-                if (newFinish > finish) finish = newFinish;
+    int nworkers = std::min(std::max(nthreads, 1), nclusters);
+    int threadsPerCluster = std::max(nthreads / nclusters, 1);
+    std::vector<std::thread> threads;
+    for (int i = 1; i < nworkers; i++) threads.emplace_back(work, threadsPerCluster);
+    work(threadsPerCluster);
+    for (std::thread& thread : threads) thread.join();
+
+    // Merge the schedules of the clusters
+    if (!failed) {
+        schedule[0] = 0;
+        schedule[sink] = 0;
+        for (int predecessor : problem.predecessors[sink])
+            schedule[sink] = std::max(schedule[sink], schedule[predecessor]);
+        if (schedule[sink] < bestMakespan) improve(schedule);
+    }
+    delete[] schedule;
+}
+
+int PrSolver::solveContracted() {
+    std::vector<std::vector<int>> chains;
+    Problem* contracted = problem.contractChains(chains);
+    int n = contracted->njobs;
+    if (n == problem.njobs) { // There are no chains
+        delete contracted;
+        return 0;
+    }
+
+    // A composite activity needs its parts to fit directly after each other, which the time-varying capacities may
+    // not allow, so the contracted problem only warm-starts the passes on the original problem with half the budget
+    int passes = std::max(npasses / 2, 1);
+    PrSolver solver(*contracted);
+    solver.setPasses(passes);
+    solver.setThreads(nthreads);
+    solver.setLayout(layout);
+    solver.setRollingHorizon(window, lookahead);
+    solver.setCancelToken(cancelled);
+    solver.setSeed(seed);
+    solver.setElitePool(eliteSize, eliteDistance);
+    solver.setPathRelinking(relink);
+    std::chrono::steady_clock::time_point contractedStart = std::chrono::steady_clock::now();
+    if (timeLimit > 0) { // Half of the remainder of the time limit
+        std::chrono::duration<double, std::milli> elapsed = contractedStart - startTime;
+        solver.setTimeLimit(std::max((timeLimit - (int)elapsed.count()) / 2, 1));
+    }
+    solver.setTarget(target);
+    if (weights != nullptr) {
+        std::vector<double> chainWeights(n);
+        for (int i = 0; i < n; i++) chainWeights[i] = weights[chains[i][0]];
+        solver.setPriorityWeights(chainWeights.data());
+    }
+    int* result = new int[n];
+    bool infeasible;
+    bool found = solver.solve(result, &infeasible);
+    if (found) {
+        int* schedule = new int[problem.njobs];
+        for (const EliteSchedule& member : solver.getElite()) {
+            problem.expandChains(chains, member.schedule.data(), schedule);
+            elite.offer(schedule, problem.durations);
+        }
+
+        // The improvements of the contracted solve, relative to the start of this solve
+        std::chrono::duration<double, std::milli> offset = contractedStart - startTime;
+        const std::vector<Improvement>& improvements = solver.getTrajectory();
+        {
+            std::lock_guard<std::mutex> lock(bestMutex);
+            for (size_t i = 0; i + 1 < improvements.size(); i++) {
+                if (improvements[i].makespan < bestMakespan)
+                    trajectory.push_back({offset.count() + improvements[i].milis, improvements[i].makespan});
             }
-            int duration = problem.durations[winner];
-            bool feasibleFinal = false;
-            while (!feasibleFinal) {
-                bool feasible = true;
-                for (int k = 0; feasible && k < problem.nresources; k++) {
-                    for (int t = duration - 1; feasible && t >= 0; t--) {
-                        if (problem.requests[winner][k][t] > available[k][finish - duration + t]) {
-                            feasible = false;
-                            finish++;
+        }
+        problem.expandChains(chains, result, schedule);
+        if (schedule[problem.njobs - 1] < bestMakespan) improve(schedule, offset.count() + improvements.back().milis);
+        delete[] schedule;
+    }
+
+    delete[] result;
+    delete contracted;
+    return passes;
+}
+
+void PrSolver::solveRolling() {
+    int sink = problem.njobs - 1;
+    int maxDuration = 0;
+    for (int job = 0; job < problem.njobs; job++) maxDuration = std::max(maxDuration, problem.durations[job]);
+    int size = window + std::max(lookahead, maxDuration);
+
+    // Length of the critical path after each activity, to estimate the makespan of a partial schedule
+    std::vector<int> tail(problem.njobs);
+    for (int job = 0; job < problem.njobs; job++) tail[job] = problem.horizon - ls[job] - problem.durations[job];
+
+    RollingProfile committed(problem, size);
+    committed.start(0);
+    std::vector<int> schedule(problem.njobs, -1);
+    schedule[0] = 0;
+    int ncommitted = 1;
+
+    for (int begin = 0; ncommitted < problem.njobs && begin <= problem.horizon; begin += window) {
+        if (begin > 0) committed.advance(begin);
+
+        // Number of unscheduled predecessors of each remaining activity, and the activities that are eligible
+        std::vector<int> missing(problem.njobs, 0), initial;
+        for (int job = 1; job < problem.njobs; job++) {
+            if (schedule[job] >= 0) continue;
+            for (int predecessor : problem.predecessors[job])
+                if (schedule[predecessor] < 0) missing[job]++;
+            if (missing[job] == 0) initial.push_back(job);
+        }
+
+        // Run passes that schedule the remaining activities within the window and the look-ahead, and keep the one
+        // with the lowest estimated makespan (or the most scheduled activities, when equal)
+        std::vector<int> bestPass;
+        int bestEstimate = INT32_MAX, bestCount = -1;
+        std::mutex passMutex;
+        nextPass = 0;
+        auto work = [&](int thread) {
+            RollingProfile profile(problem, size);
+            std::vector<int> trial, remaining, eligible;
+            std::default_random_engine eng(workerSeed(thread) + begin);
+            std::uniform_real_distribution<double> distribution(0, 1);
+            while (nextPass.fetch_add(1) < npasses && std::chrono::steady_clock::now() < deadline &&
+                   (cancelled == nullptr || !cancelled->load(std::memory_order_relaxed))) {
+                trial = schedule;
+                remaining = missing;
+                eligible = initial;
+                profile.copy(committed);
+                int estimate = 0, count = 0;
+                while (!eligible.empty()) {
+                    int neligible = (int)eligible.size();
+                    int Z = std::max((int)(TOURN_FACTOR * neligible), 2);
+                    int bestRank = problem.njobs, position = 0;
+                    for (int j = 0; j < Z; j++) {
+                        int choice = (int)(distribution(eng) * neligible);
+                        if (rank[eligible[choice]] < bestRank) {
+                            bestRank = rank[eligible[choice]];
+                            position = choice;
                         }
                     }
+                    int winner = eligible[position];
+                    eligible[position] = eligible.back();
+                    eligible.pop_back();
+
+                    int finish = -1;
+                    for (int predecessor : problem.predecessors[winner])
+                        finish = std::max(finish, trial[predecessor] + problem.durations[winner]);
+                    finish = profile.earliestFinish(winner, finish);
+                    if (finish > profile.end()) {
+                        // Does not fit before the end of the look-ahead, so it is left to a later window
+                        estimate = std::max(estimate, profile.end() + problem.durations[winner] + tail[winner]);
+                        continue;
+                    }
+                    trial[winner] = finish;
+                    profile.place(winner, finish);
+                    estimate = std::max(estimate, finish + tail[winner]);
+                    count++;
+                    for (int i = 0; i < problem.nsuccessors[winner]; i++) {
+                        int successor = problem.successors[winner][i];
+                        if (--remaining[successor] == 0) eligible.push_back(successor);
+                    }
                 }
-                if (feasible) feasibleFinal = true;
-                if (finish > problem.horizon) {
-                    feasibleFinal = false;
-                    break;
+
+                std::lock_guard<std::mutex> lock(passMutex);
+                if (estimate < bestEstimate || (estimate == bestEstimate && count > bestCount)) {
+                    bestEstimate = estimate;
+                    bestCount = count;
+                    bestPass = trial;
                 }
             }
-            if (!feasibleFinal) break; // Skip the rest of this pass
-            schedule[winner] = finish;
+        };
+        if (nthreads <= 1) work(0);
+        else {
+            std::vector<std::thread> threads;
+            for (int i = 0; i < nthreads; i++) threads.emplace_back(work, i);
+            for (std::thread& thread : threads) thread.join();
+        }
+        if (bestPass.empty()) break; // The time limit was reached, or the solve was cancelled
+
+        // Commit the activities that start within the window, the others are scheduled again in the next window
+        for (int job = 1; job < problem.njobs; job++) {
+            if (schedule[job] >= 0 || bestPass[job] < 0 || bestPass[job] - problem.durations[job] >= begin + window)
+                continue;
+            schedule[job] = bestPass[job];
+            committed.place(job, schedule[job]);
+            ncommitted++;
+        }
+    }
+
+    if (ncommitted == problem.njobs && schedule[sink] <= problem.horizon) improve(schedule.data());
+}
+
+void PrSolver::runWorkers(const ProfileSummary& summary) {
+    std::chrono::steady_clock::time_point runStart = std::chrono::steady_clock::now();
+    if (nthreads <= 1) {
+        Worker worker(problem, summary, workerSeed(0));
+        runPasses(worker);
+    }
+    else {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < nthreads; i++) {
+            threads.emplace_back([this, &summary, i]() {
+                Worker worker(problem, summary, workerSeed(i));
+                runPasses(worker);
+            });
+        }
+        for (std::thread& thread : threads) thread.join();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - runStart;
+    passMilis += elapsed.count();
+}
+
+/**
+ * State of a solve, as written to a checkpoint file.
+ */
+struct PrSolver::Checkpoint {
+    int nextPass;                         // Number of passes that were run
+    int makespan;                         // Makespan of the incumbent, or a value larger than the horizon
+    std::vector<int> schedule;            // End times of the incumbent (empty if there is none)
+    double milis;                         // Wall-clock time of the solve so far
+    std::vector<Improvement> trajectory;  // Improvements so far
+    std::string engine;                   // State of the random number generator of step()
+    std::vector<std::vector<int>> elite;  // End times of the schedules of the elite pool, by increasing makespan
+};
+
+#define CHECKPOINT_MAGIC 0x43504352 // "RCPC" in little endian
+#define CHECKPOINT_VERSION 2
+
+bool PrSolver::saveCheckpoint(const std::string& path) {
+    if (summary == nullptr) return false;
+    if (stepWorker == nullptr) stepWorker.reset(new Worker(problem, *summary, workerSeed(0)));
+
+    std::string temporary = path + ".tmp";
+    std::ofstream output(temporary, std::ios::binary);
+    if (!output) return false;
+    auto write = [&](const void* data, size_t size) { output.write((const char*)data, (std::streamsize)size); };
+    auto writeInt = [&](int32_t value) { write(&value, sizeof(value)); };
+
+    uint64_t fingerprint = problem.fingerprint();
+    writeInt(CHECKPOINT_MAGIC);
+    writeInt(CHECKPOINT_VERSION);
+    write(&fingerprint, sizeof(fingerprint));
+    writeInt(problem.njobs);
+    writeInt(std::min((int)nextPass, npasses));
+    {
+        std::lock_guard<std::mutex> lock(bestMutex);
+        int makespan = bestMakespan;
+        writeInt(makespan);
+        writeInt(makespan <= problem.horizon ? 1 : 0);
+        if (makespan <= problem.horizon) write((int*)best, problem.njobs * sizeof(int));
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+        double milis = elapsed.count();
+        write(&milis, sizeof(milis));
+        writeInt((int)trajectory.size());
+        for (const Improvement& improvement : trajectory) {
+            write(&improvement.milis, sizeof(improvement.milis));
+            writeInt(improvement.makespan);
+        }
+    }
+    std::ostringstream engine;
+    engine << stepWorker->eng;
+    writeInt((int)engine.str().size());
+    write(engine.str().data(), engine.str().size());
+    std::vector<EliteSchedule> members = elite.get();
+    writeInt((int)members.size());
+    for (const EliteSchedule& member : members) write(member.schedule.data(), problem.njobs * sizeof(int));
 
-            // Update remaining resource availabilities
-            for (int k = 0; k < problem.nresources; k++) {
-                for (int t = 0; t < duration; t++)
-                    available[k][finish - duration + t] -= problem.requests[winner][k][t];
+    output.close();
+    if (!output) return false;
+    return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+bool PrSolver::loadCheckpoint(const std::string& path) {
+    std::ifstream input(path, std::ios::binary);
+    if (!input) return false;
+    auto read = [&](void* data, size_t size) { return (bool)input.read((char*)data, (std::streamsize)size); };
+    auto readInt = [&](int32_t& value) { return read(&value, sizeof(value)); };
+
+    int32_t magic, version, njobs, hasSchedule, ntrajectory, length, nelite;
+    uint64_t fingerprint;
+    if (!readInt(magic) || magic != CHECKPOINT_MAGIC || !readInt(version) || version != CHECKPOINT_VERSION) return false;
+    if (!read(&fingerprint, sizeof(fingerprint)) || fingerprint != problem.fingerprint()) return false;
+    if (!readInt(njobs) || njobs != problem.njobs) return false;
+
+    std::unique_ptr<Checkpoint> checkpoint(new Checkpoint());
+    if (!readInt(checkpoint->nextPass) || !readInt(checkpoint->makespan) || !readInt(hasSchedule)) return false;
+    if (hasSchedule) {
+        checkpoint->schedule.resize(njobs);
+        if (!read(checkpoint->schedule.data(), njobs * sizeof(int))) return false;
+    }
+    if (!read(&checkpoint->milis, sizeof(checkpoint->milis)) || !readInt(ntrajectory) || ntrajectory < 0) return false;
+    checkpoint->trajectory.resize(ntrajectory);
+    for (Improvement& improvement : checkpoint->trajectory)
+        if (!read(&improvement.milis, sizeof(improvement.milis)) || !readInt(improvement.makespan)) return false;
+    if (!readInt(length) || length < 0) return false;
+    checkpoint->engine.resize(length);
+    if (!read(&checkpoint->engine[0], length)) return false;
+    if (!readInt(nelite) || nelite < 0) return false;
+    checkpoint->elite.resize(nelite, std::vector<int>(njobs));
+    for (std::vector<int>& schedule : checkpoint->elite)
+        if (!read(schedule.data(), njobs * sizeof(int))) return false;
+
+    resumed = std::move(checkpoint);
+    return true;
+}
+
+void PrSolver::resume(const Checkpoint& checkpoint) {
+    // Continue the timeline and the pass counter of the interrupted solve
+    startTime = std::chrono::steady_clock::now() -
+                std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double, std::milli>(checkpoint.milis));
+    if (timeLimit > 0) deadline = startTime + std::chrono::milliseconds(timeLimit);
+    nextPass = checkpoint.nextPass;
+    {
+        std::lock_guard<std::mutex> lock(bestMutex);
+        trajectory = checkpoint.trajectory;
+        if (!checkpoint.schedule.empty() && checkpoint.makespan < bestMakespan) {
+            bestMakespan = checkpoint.makespan;
+            for (int i = 0; i < problem.njobs; i++) best[i] = checkpoint.schedule[i];
+        }
+    }
+    for (const std::vector<int>& schedule : checkpoint.elite) elite.offer(schedule.data(), problem.durations);
+    stepWorker.reset(new Worker(problem, *summary, workerSeed(0)));
+    std::istringstream engine(checkpoint.engine);
+    engine >> stepWorker->eng;
+}
+
+unsigned PrSolver::workerSeed(int index) const {
+    return seed != 0 ? seed + (unsigned)index : std::random_device()();
+}
+
+bool PrSolver::passesRemain() const {
+    return nextPass < npasses && searchRemains();
+}
+
+bool PrSolver::searchRemains() const {
+    if (bestMakespan <= stopMakespan) return false;
+    if (cancelled != nullptr && cancelled->load(std::memory_order_relaxed)) return false;
+    return deadline == std::chrono::steady_clock::time_point::max() || std::chrono::steady_clock::now() < deadline;
+}
+
+void PrSolver::runPasses(Worker& worker) {
+    bool timed = deadline != std::chrono::steady_clock::time_point::max();
+    uint64_t passes = 0, pruned = 0;
+    while (bestMakespan.load(std::memory_order_relaxed) > stopMakespan && nextPass.fetch_add(1) < passLimit) {
+        if (timed && std::chrono::steady_clock::now() >= deadline) break;
+        if (cancelled != nullptr && cancelled->load(std::memory_order_relaxed)) break;
+        passes++;
+        if (!pass(worker)) pruned++;
+        else if (worker.schedule[problem.njobs - 1] < bestMakespan.load(std::memory_order_relaxed))
+            improve(worker.schedule);
+        else elite.offer(worker.schedule, problem.durations);
+    }
+    passCount += (int)passes;
+    Metrics::add(Counter::Passes, passes);
+    Metrics::add(Counter::PrunedPasses, pruned);
+}
+
+void PrSolver::startPass(Worker& worker) {
+    for (int i = 0; i < problem.njobs; i++) worker.schedule[i] = -1;
+
+    // Initialize remaining resource availabilities
+    worker.profile.reset();
+
+    // Schedule the starting dummy activity
+    worker.schedule[0] = 0;
+
+    // Schedule the activities that cannot be moved
+    if (fixedEnds != nullptr) {
+        for (int job = 1; job < problem.njobs; job++) {
+            if (fixedEnds[job] < 0) continue;
+            worker.schedule[job] = fixedEnds[job];
+            worker.profile.place(job, fixedEnds[job]);
+        }
+    }
+}
+
+int PrSolver::placeEarliest(Worker& worker, int job) {
+    int* schedule = worker.schedule;
+
+    // Schedule it as early as possible
+    int finish = releases != nullptr ? releases[job] + problem.durations[job] : -1;
+    for (int predecessor : problem.predecessors[job]) {
+        int newFinish = schedule[predecessor] + problem.durations[job];
+        if (newFinish > finish) finish = newFinish;
+    }
+    finish = worker.profile.earliestFinish(job, finish);
+    if (finish > problem.horizon) return finish;
+    schedule[job] = finish;
+
+    // Update remaining resource availabilities
+    worker.profile.place(job, finish);
+    return finish;
+}
+
+bool PrSolver::pass(Worker& worker) {
+    int* eligible = worker.eligible;
+    int* selected = worker.selected;
+    int* schedule = worker.schedule;
+    int neligible, nselected;
+
+    startPass(worker);
+
+    // Schedule all remaining jobs
+    for (int i = 1 + nfixed; i < problem.njobs; i++) {
+        // Randomly select a fraction of the eligible activities (with replacement)
+        neligible = 0;
+        for (int j = 1; j < problem.njobs; j++) {
+            if (schedule[j] < 0) {
+                bool predecessorsScheduled = true;
+                for (int predecessor : problem.predecessors[j])
+                    if (schedule[predecessor] < 0) predecessorsScheduled = false;
+                if (predecessorsScheduled) eligible[neligible++] = j;
             }
         }
+        int Z = std::max((int)(TOURN_FACTOR * neligible), 2);
+        nselected = 0;
+        for (int j = 0; j < Z; j++) {
+            int choice = (int)(worker.distribution(worker.eng) * neligible);
+            selected[nselected++] = eligible[choice];
+        }
+
+        // Select the activity with the best priority value (lowest rank)
+        int bestRank = problem.njobs;
+        for (int j = 0; j < nselected; j++) bestRank = std::min(bestRank, rank[selected[j]]);
+        int winner = byRank[bestRank];
+
+        if (placeEarliest(worker, winner) > problem.horizon) return false; // Skip the rest of this pass
+    }
+
+    return true;
+}
+
+bool PrSolver::placeListed(Worker& worker, int job) {
+    if (worker.schedule[job] >= 0) return true; // The source or an activity that cannot be moved
+
+    // Lists of start times do not order activities with equal start times topologically (e.g. zero-duration ones)
+    for (int predecessor : problem.predecessors[job])
+        if (worker.schedule[predecessor] < 0) return false;
+    return placeEarliest(worker, job) <= problem.horizon;
+}
 
-        if (schedule[problem.njobs - 1] >= 0 && schedule[problem.njobs - 1] < bestMakespan) {
-            bestMakespan = schedule[problem.njobs - 1];
-            for (int i = 0; i < problem.njobs; i++) out[i] = schedule[i];
+void PrSolver::relinkElite() {
+    std::vector<EliteSchedule> members = elite.get();
+    if (members.size() < 2 || !searchRemains()) return;
+
+    // Relink each pair in both directions, the pairs with the best schedules first
+    std::vector<std::pair<int, int>> pairs;
+    for (int i = 0; i < (int)members.size(); i++) {
+        for (int j = i + 1; j < (int)members.size(); j++) {
+            pairs.emplace_back(i, j);
+            pairs.emplace_back(j, i);
         }
     }
+    std::stable_sort(pairs.begin(), pairs.end(), [&members](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+        return members[a.first].makespan + members[a.second].makespan <
+               members[b.first].makespan + members[b.second].makespan;
+    });
 
-    delete[] ef;
-    delete[] ls;
-    delete[] ru;
-    delete[] cpru;
-    for (int x = 0; x < problem.nresources; x++) delete[] available[x];
-    delete[] available;
-    delete[] eligible;
-    delete[] selected;
-    delete[] schedule;
-    return bestMakespan <= problem.horizon;
+    std::atomic<int> nextPair(0);
+    auto relinkPairs = [this, &members, &pairs, &nextPair](int index) {
+        Worker prefix(problem, *summary, workerSeed(index));
+        Worker trial(problem, *summary, workerSeed(index));
+        std::vector<int> list;
+        int i;
+        while ((i = nextPair.fetch_add(1)) < (int)pairs.size() && searchRemains())
+            relinkPair(prefix, trial, members[pairs[i].first], members[pairs[i].second], list);
+    };
+    if (nthreads <= 1) relinkPairs(0);
+    else {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < nthreads; i++) threads.emplace_back(relinkPairs, i);
+        for (std::thread& thread : threads) thread.join();
+    }
+}
+
+void PrSolver::relinkPair(Worker& prefix, Worker& trial, const EliteSchedule& from, const EliteSchedule& to,
+                          std::vector<int>& list) {
+    int n = problem.njobs;
+    list = from.order;
+    startPass(prefix);
+
+    // Time steps at which the profile of trial may differ from the profile of prefix, so that only these are copied
+    // before decoding a suffix (all of them before the first copy)
+    int dirtyBegin = 0, dirtyEnd = problem.horizon;
+    auto placeTouched = [this, &dirtyBegin, &dirtyEnd](Worker& worker, int job) {
+        if (!placeListed(worker, job)) return false;
+        dirtyBegin = std::min(dirtyBegin, worker.schedule[job] - problem.durations[job]);
+        dirtyEnd = std::max(dirtyEnd, worker.schedule[job]);
+        return true;
+    };
+
+    int p = 0; // Length of the prefix that is placed in prefix
+    while (true) {
+        // Extend the prefix that the list shares with the guiding list
+        while (p < n && list[p] == to.order[p]) {
+            if (!placeTouched(prefix, list[p++])) return;
+        }
+        if (p == n || !searchRemains()) return;
+
+        // Move the next activity of the guiding list forward. Its predecessors are usually in the shared prefix, but
+        // not if the guiding list orders activities with equal start times against the precedences, which ends this
+        // path.
+        int q = (int)(std::find(list.begin() + p, list.end(), to.order[p]) - list.begin());
+        std::rotate(list.begin() + p, list.begin() + q, list.begin() + q + 1);
+        if (!placeTouched(prefix, list[p++])) return;
+        if (std::equal(list.begin() + p, list.end(), to.order.begin() + p)) return; // The guiding list is reached
+
+        // Decode the rest of the intermediate list, continuing from the prefix
+        trial.profile.copy(prefix.profile, dirtyBegin, dirtyEnd);
+        std::copy(prefix.schedule, prefix.schedule + n, trial.schedule);
+        dirtyBegin = problem.horizon;
+        dirtyEnd = 0;
+        bool placed = true;
+        for (int i = p; placed && i < n; i++) placed = placeTouched(trial, list[i]);
+        if (placed && trial.schedule[n - 1] < bestMakespan.load(std::memory_order_relaxed)) improve(trial.schedule);
+    }
+}
+
+void PrSolver::improve(const int* schedule, double milis) {
+    elite.offer(schedule, problem.durations);
+    std::lock_guard<std::mutex> lock(bestMutex);
+    int makespan = schedule[problem.njobs - 1];
+    if (makespan >= bestMakespan) return; // Another thread found a better schedule in the meantime
+
+    bestMakespan = makespan;
+    for (int i = 0; i < problem.njobs; i++) best[i] = schedule[i];
+    if (milis < 0) {
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+        milis = elapsed.count();
+    }
+    trajectory.push_back({milis, makespan});
+    Metrics::add(Counter::Improvements);
+}
+
+bool PrSolver::pollIncumbent(int* out) {
+    std::lock_guard<std::mutex> lock(bestMutex);
+    int* current = best;
+    if (current == nullptr || bestMakespan > problem.horizon) return false;
+    for (int i = 0; i < problem.njobs; i++) out[i] = current[i];
+    return true;
+}
+
+bool PrSolver::getTimeWindows(TimeWindow* out) const {
+    if (!preprocessed) return false;
+
+    for (int job = 0; job < problem.njobs; job++) {
+        int duration = problem.durations[job];
+        TimeWindow& window = out[job];
+        window.earliestStart = ef[job] - duration;
+        window.latestFinish = ls[job] + duration;
+        window.feasibleStarts.assign(ls[job] - window.earliestStart + 1, true);
+
+        // Check each start time in the window against the resource capacities
+        for (int start = window.earliestStart; start <= ls[job]; start++) {
+            bool feasible = true;
+            for (int i = 0; feasible && i < problem.nused[job]; i++) {
+                int k = problem.used[job][i];
+                for (int t = 0; feasible && t < duration; t++) {
+                    if (problem.requests[job][k][t] > problem.capacity(k, start + t)) feasible = false;
+                }
+            }
+            window.feasibleStarts[start - window.earliestStart] = feasible;
+        }
+    }
+
+    return true;
 }
 
 bool GaSolver::solve(int *out) {
@@ -23,10 +23,51 @@ SOFTWARE.
 #ifndef RCPSPT_HEURISTIC_SOLVER_H
 #define RCPSPT_HEURISTIC_SOLVER_H
 
+#include <vector>
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <algorithm>
+
 #include "Problem.h"
+#include "Profile.h"
+#include "ElitePool.h"
 
 namespace RcpsptHeuristic {
 
+/**
+ * Time window of an activity, as propagated by the preprocessing steps of a solver.
+ */
+struct TimeWindow {
+    int earliestStart;                // Earliest feasible start time
+    int latestFinish;                 // Latest feasible finish time
+    std::vector<bool> feasibleStarts; // For each start time in [earliestStart, latestFinish - duration], whether the
+                                      // activity fits within the resource capacities when started at that time
+};
+
+/**
+ * Improvement of the incumbent during a solve, used for anytime profiles.
+ */
+struct Improvement {
+    double milis; // Wall-clock time since the start of the solve
+    int makespan; // Makespan of the new incumbent
+};
+
+/**
+ * Disruption of a schedule that is being executed.
+ */
+struct Disruption {
+    int job;      // Activity that is delayed, or -1 if none
+    int release;  // Time before which the delayed activity cannot start
+    int resource; // Resource of which the capacity drops, or -1 if none
+    int from;     // First time step of the capacity drop
+    int to;       // Time step after the last time step of the capacity drop
+    int amount;   // Amount by which the capacity drops
+};
+
 /**
  * Abstract base class for a solver for the RCPSP/t.
  */
@@ -57,10 +98,372 @@ protected:
  */
 class PrSolver : public Solver {
 public:
-    explicit PrSolver(Problem& p)
-        : Solver(p) {}
+    explicit PrSolver(Problem& p);
+    ~PrSolver();
 
     bool solve(int* out, bool* infeasible);
+
+    /**
+     * Starts a solve that runs its passes in steps on the calling thread (see step()), so that many solves can be
+     * interleaved on a fixed number of threads. Equivalent to solve() when followed by step() until it returns false
+     * and then finish(), except that the passes run on a single thread. Decomposition, the solve of the contracted
+     * problem (see setContractChains()) and the rolling-horizon mode are completed within this call.
+     *
+     * @param out vector to which end times for all activities will be written
+     * @param infeasible indicates whether the preprocessing steps found the instance to be infeasible
+     * @return true if passes remain to be run by step(), false otherwise
+     */
+    bool begin(int* out, bool* infeasible);
+
+    /**
+     * Runs passes of a solve that was started by begin().
+     *
+     * @param n the maximum number of passes to run
+     * @return true if passes remain, false if the solve is complete (all passes were run, the lower bound or target
+     *         was reached, the time limit passed or the solve was cancelled)
+     */
+    bool step(int n);
+
+    /**
+     * Completes a solve that was started by begin().
+     *
+     * @return true if a solution was found, false otherwise
+     */
+    bool finish();
+
+    /**
+     * Writes the state of a solve that was started by begin() to a binary checkpoint file: the pass counter, the
+     * incumbent, the improvements so far, the elapsed time and the state of the random number generator of step().
+     * The file is replaced atomically. Must be called between calls to step().
+     *
+     * @param path the checkpoint file
+     * @return true if the checkpoint was written, false otherwise
+     */
+    bool saveCheckpoint(const std::string& path);
+
+    /**
+     * Loads a checkpoint of a solve of the same problem, to be resumed by the next call to begin() (or solve()).
+     * With the same seed and configuration, a single-threaded solve continues identically to one that was not
+     * interrupted.
+     *
+     * @param path the checkpoint file
+     * @return true if the checkpoint was loaded, false if it cannot be read or belongs to another problem
+     */
+    bool loadCheckpoint(const std::string& path);
+
+    /**
+     * Exposes the time windows that were computed while preprocessing, for use by external (CP/MIP) models.
+     * Can only be called after solve(), and only if preprocessing did not find the instance to be infeasible.
+     *
+     * @param out vector to which the time window of each activity will be written
+     * @return true if time windows are available, false otherwise
+     */
+    bool getTimeWindows(TimeWindow* out) const;
+
+    /**
+     * Repairs a schedule that is being executed after a disruption. The capacity drop (if any) is applied to the
+     * problem. Started activities keep their times, even if the capacity drop overloads a resource during their
+     * execution: the repaired schedule then does not pass Problem::validate, and the overloaded time steps are
+     * reported. The other activities are first right-shifted: they are placed as early as possible from the current
+     * time in the order of their current start times. The remaining time budget is spent on passes that re-sample the
+     * order of these activities. Uses the priority values of the last call to solve(), if any.
+     *
+     * @param schedule current end times for all activities
+     * @param now the current time
+     * @param started whether each activity has started (and cannot be moved), or nullptr to consider all activities
+     *        that start before the current time as started
+     * @param disruption the disruption
+     * @param budget time budget in milliseconds for the passes
+     * @param out vector to which the repaired end times for all activities will be written
+     * @param overloads vector to which the (resource, time step) pairs at which the started activities exceed the
+     *        dropped capacity will be written, or nullptr
+     * @return true if a repaired schedule was found, false otherwise
+     */
+    bool repair(const int* schedule, int now, const bool* started, const Disruption& disruption, int budget, int* out,
+                std::vector<std::pair<int, int>>* overloads = nullptr);
+
+    /**
+     * @return the best makespan found by the last call to solve(), or a value larger than the horizon if none was found
+     */
+    int getUpperBound() const { return bestMakespan; }
+
+    /**
+     * Copies the best schedule found so far by a solve that is running on another thread (or by the last solve, while
+     * its output vector exists).
+     *
+     * @param out vector to which end times for all activities will be written
+     * @return true if a schedule was found, false otherwise
+     */
+    bool pollIncumbent(int* out);
+
+    /**
+     * @return the earliest feasible finish time of the sink activity, which is a lower bound on the makespan (only
+     *         meaningful after solve() if preprocessing did not find the instance to be infeasible)
+     */
+    int getLowerBound() const { return ef[problem.njobs - 1]; }
+
+    /**
+     * Sets a known feasible schedule as the initial incumbent (warm start) for the next call to solve().
+     * Passes stop as soon as the incumbent is proven optimal by the lower bound.
+     *
+     * @param schedule end times for all activities
+     */
+    void setIncumbent(const int* schedule);
+
+    /**
+     * Sets a target makespan: passes stop as soon as a schedule with at most this makespan was found.
+     *
+     * @param makespan the target makespan
+     */
+    void setTarget(int makespan) { target = makespan; }
+
+    /**
+     * Sets a weight per activity by which its priority value is multiplied (e.g. to prefer the activities of some
+     * projects in a multi-project problem).
+     *
+     * @param w the weight for each activity
+     */
+    void setPriorityWeights(const double* w);
+
+    /**
+     * Sets the number of passes (tournaments) to run.
+     *
+     * @param n the number of passes
+     */
+    void setPasses(int n) { npasses = n; }
+
+    /**
+     * Sets a time limit: no new passes are started after this many milliseconds since the start of a solve. A resumed
+     * solve counts the time of the interrupted solve (as recorded in the checkpoint) as well.
+     *
+     * @param milis the time limit, or 0 for no time limit
+     */
+    void setTimeLimit(int milis) { timeLimit = milis; }
+
+    /**
+     * Sets the number of threads that run passes (and wide levels of the preprocessing steps) in parallel.
+     *
+     * @param n the number of threads
+     */
+    void setThreads(int n) { nthreads = n; }
+
+    /**
+     * Sets a cancellation token: no new passes are started once it is set (from another thread), after which solve()
+     * returns the best schedule found so far.
+     *
+     * @param token the token, or nullptr for no cancellation
+     */
+    void setCancelToken(const std::atomic<bool>* token) { cancelled = token; }
+
+    /**
+     * Enables checkpointing in solve(): a solve resumes from the checkpoint file if it exists, runs its passes in steps
+     * (on a single thread) and writes a checkpoint after each step. The file is removed when the solve completes.
+     *
+     * @param path the checkpoint file, or an empty string to disable checkpointing
+     * @param interval the number of passes between checkpoints
+     */
+    void setCheckpoint(const std::string& path, int interval) {
+        checkpointPath = path;
+        checkpointInterval = std::max(interval, 1);
+    }
+
+    /**
+     * Sets the seed of the random number generators of the passes, so that a single-threaded solve is reproducible.
+     *
+     * @param s the seed, or 0 to seed from a random device
+     */
+    void setSeed(unsigned s) { seed = s; }
+
+    /**
+     * Sets the memory layout of the remaining resource availabilities during the passes.
+     *
+     * @param l the layout
+     */
+    void setLayout(Layout l) { layout = l; }
+
+    /**
+     * Enables decomposition: the precedence graph (without the dummy activities) is split into weakly connected
+     * components, components that use common resources are grouped, and the groups are solved independently (in
+     * parallel) after which their schedules are merged.
+     *
+     * @param enable whether to decompose the problem
+     */
+    void setDecompose(bool enable) { decompose = enable; }
+
+    /**
+     * Enables chain contraction: chains of activities that are linked only to each other are scheduled as composite
+     * activities (directly after each other), which reduces the number of decisions per pass. Half of the passes
+     * (and of the time limit) solve the contracted problem, whose expanded schedules, elite pool and improvements are
+     * carried over; the other half run on the original problem, as a composite activity may not fit where its parts
+     * would, and the better schedule is kept.
+     *
+     * @param enable whether to contract chains
+     */
+    void setContractChains(bool enable) { contract = enable; }
+
+    /**
+     * Enables the rolling-horizon mode: activities are scheduled window by window. In each window, passes schedule the
+     * remaining activities within the window and a look-ahead, and the activities of the best pass that start within
+     * the window are committed. The remaining availabilities are only kept for the window and the look-ahead (which
+     * is extended to the longest duration), and no memory over the whole horizon is allocated apart from the
+     * capacities of the problem (which only cover one period for periodic calendars). The number of passes applies to
+     * each window.
+     *
+     * @param w the number of time steps in a window, or 0 to schedule the whole horizon at once
+     * @param l the number of time steps of the look-ahead
+     */
+    void setRollingHorizon(int w, int l) {
+        window = w;
+        lookahead = l;
+    }
+
+    /**
+     * Keeps an elite pool of the best schedules that are distinct in activity order (see ElitePool), filled by the
+     * passes and the improvements of each solve.
+     *
+     * @param size the maximum number of schedules, or 0 to keep no pool
+     * @param distance the minimum distance between the activity lists of two schedules, or -1 for the number of
+     *        activities
+     */
+    void setElitePool(int size, long distance = -1) {
+        eliteSize = size;
+        eliteDistance = distance;
+    }
+
+    /**
+     * Enables path relinking after the passes of a solve: for pairs of schedules of the elite pool (of 8 schedules if
+     * no size was set), the activity list of one is moved towards the other one activity at a time, and each
+     * intermediate list is decoded by the serial schedule generation scheme. The decoding continues from the
+     * state after the prefix that the list shares with the previous one. Pairs run on the threads of the solver, best
+     * pairs first, until the time limit (shared with the passes) is reached.
+     *
+     * @param r whether to relink
+     */
+    void setPathRelinking(bool r) { relink = r; }
+
+    /**
+     * @return the schedules of the elite pool of the last solve, by increasing makespan (empty without a pool)
+     */
+    std::vector<EliteSchedule> getElite() const { return elite.get(); }
+
+    /**
+     * @return the improvements of the incumbent during the last call to solve(), in chronological order
+     */
+    const std::vector<Improvement>& getTrajectory() const { return trajectory; }
+
+    /**
+     * @return a compact description of the solver configuration (without whitespace)
+     */
+    std::string getConfig() const;
+
+    /**
+     * Applies comma-separated settings, in the format of getConfig() (the "pr:" prefix is optional): passes=n,
+     * threads=n, layout=time-major|resource-major, decompose, contract, rolling=window:look-ahead, time=milis, seed=n,
+     * elite=size[:distance], relink.
+     *
+     * @param settings the settings
+     * @return true if all settings were applied, false if a setting is not recognised (the settings before it are
+     *         applied)
+     */
+    bool configure(const std::string& settings);
+
+    /**
+     * @return the time limit in milliseconds, or 0 if there is none
+     */
+    int getTimeLimit() const { return timeLimit; }
+
+    /**
+     * @return the number of passes per solve
+     */
+    int getPasses() const { return npasses; }
+
+    /**
+     * @return the number of passes that were run during the last solve (not counting those of sub-solvers for
+     *         decomposition, chain contraction or a rolling horizon)
+     */
+    int getPassCount() const { return passCount; }
+
+    /**
+     * @return the time in milliseconds that was spent running the passes of the last solve
+     */
+    double getPassTime() const { return passMilis; }
+
+private:
+    struct Worker;
+    struct Checkpoint;
+
+    bool computeLevels();
+    void forEachLevel(bool backwards, const std::function<void(int)>& process);
+    int shiftFinish(int job, int finish) const;
+    int shiftStart(int job, int start) const;
+    bool preprocess();
+    std::vector<std::vector<int>> findClusters() const;
+    void solveClusters(const std::vector<std::vector<int>>& clusters);
+    void solveRolling();
+    int solveContracted();
+    void runWorkers(const ProfileSummary& summary);
+    void runPasses(Worker& worker);
+    bool passesRemain() const;
+    bool searchRemains() const;
+    unsigned workerSeed(int index) const;
+    void resume(const Checkpoint& checkpoint);
+    void startPass(Worker& worker);
+    int placeEarliest(Worker& worker, int job);
+    bool pass(Worker& worker);
+    void improve(const int* schedule, double milis = -1);
+    bool placeListed(Worker& worker, int job);
+    void relinkElite();
+    void relinkPair(Worker& prefix, Worker& trial, const EliteSchedule& from, const EliteSchedule& to,
+                    std::vector<int>& list);
+
+    int* ef;           // Earliest feasible finish times for all jobs
+    int* ls;           // Latest feasible start times for all jobs
+    double* ru;        // Extended resource utilization values for all jobs
+    double* cpru;      // CPRU priority values for all jobs
+    int* rank;         // Rank of the priority value of each job (0 is the highest priority)
+    int* byRank;       // Job for each rank
+    int* incumbent;    // Schedule to start from, or nullptr
+    double* weights;   // Weight of the priority value of each job, or nullptr
+    int target;        // Makespan at which to stop the passes
+    int npasses;       // Number of passes to run
+    int timeLimit;     // Time limit of a solve in milliseconds, or 0
+    const std::atomic<bool>* cancelled; // Cancellation token, or nullptr
+    unsigned seed;     // Seed of the random number generators, or 0
+    std::string checkpointPath; // Checkpoint file of solve(), or empty
+    int checkpointInterval;     // Number of passes between checkpoints
+    int nthreads;      // Number of threads that run passes
+    Layout layout;     // Memory layout of the remaining resource availabilities
+    bool decompose;    // Whether to solve independent parts of the problem separately
+    bool contract;     // Whether to schedule chains of activities as composite activities
+    int window;        // Number of time steps in a window of the rolling-horizon mode, or 0
+    int lookahead;     // Number of time steps of the look-ahead of the rolling-horizon mode
+    int eliteSize;     // Maximum number of schedules of the elite pool, or 0
+    long eliteDistance; // Minimum distance between the schedules of the elite pool, or -1 for the number of jobs
+    bool relink;       // Whether to relink the schedules of the elite pool after the passes
+    bool preprocessed; // Whether the above values were successfully calculated
+
+    std::vector<int> levelOrder; // Jobs ordered by topological level of the precedence graph
+    std::vector<int> levelStart; // Index in levelOrder of the first job of each level (and the end of the last level)
+
+    // State of the current solve, shared between the threads that run passes
+    std::atomic<int*> best;            // Best schedule found so far (output vector of the current solve)
+    std::atomic<int> bestMakespan;     // Makespan of the best schedule found so far
+    std::atomic<int> nextPass;         // Index of the next pass to run
+    int passLimit;                     // Index of the pass at which the workers stop
+    int stopMakespan;                  // Makespan at which the passes stop (target or lower bound)
+    std::chrono::steady_clock::time_point deadline; // Time after which no new passes are started
+    int* fixedEnds;                    // End time of each activity that cannot be moved (or -1), or nullptr
+    int* releases;                     // Earliest start time of each activity, or nullptr
+    int nfixed;                        // Number of activities other than the source with a fixed end time
+    std::mutex bestMutex;              // Protects best and trajectory
+    std::vector<Improvement> trajectory;
+    std::chrono::steady_clock::time_point startTime;
+    double passMilis;                  // Time spent running passes in the current solve
+    std::atomic<int> passCount;        // Number of passes run in the current solve
+    ElitePool elite;                   // Best distinct schedules of the current solve
+    std::unique_ptr<ProfileSummary> summary; // Summary of the problem for the passes of the current solve
+    std::unique_ptr<Worker> stepWorker;      // Worker that runs the passes of step()
+    std::unique_ptr<Checkpoint> resumed;     // Checkpoint to resume from in the next call to begin(), or nullptr
 };
 
 /**
@@ -0,0 +1,119 @@
+/********************************************************************************[CheckpointTest.cc]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Solver.h"
+#include "TestInstance.h"
+
+using namespace RcpsptHeuristic;
+
+static const int NPASSES = 400;
+static const unsigned SEED = 17;
+
+/**
+ * Configures a single-threaded, reproducible solver.
+ */
+static void configure(PrSolver& solver, int elite) {
+    solver.setPasses(NPASSES);
+    solver.setThreads(1);
+    solver.setSeed(SEED);
+    solver.setElitePool(elite);
+}
+
+/**
+ * Checks that a single-threaded solve that is interrupted after some passes and resumed from its checkpoint finds the
+ * same schedule as a solve that was not interrupted, and that a resumed solve counts the interrupted time towards
+ * its time limit.
+ */
+int main() {
+    std::string path = "checkpoint_test.bin";
+    int failures = 0;
+    for (unsigned instance = 1; instance <= 4; instance++) {
+        Problem problem = generateInstance(40, 3, instance);
+        int elite = instance % 2 == 0 ? 4 : 0;
+
+        std::vector<int> expected(problem.njobs);
+        bool infeasible;
+        PrSolver full(problem);
+        configure(full, elite);
+        if (!full.solve(expected.data(), &infeasible)) {
+            std::cerr << "Instance " << instance << " was not solved" << std::endl;
+            failures++;
+            continue;
+        }
+
+        for (int k : {1, NPASSES / 3, NPASSES - 1}) {
+            std::vector<int> partial(problem.njobs), resumed(problem.njobs);
+            PrSolver interrupted(problem);
+            configure(interrupted, elite);
+            interrupted.begin(partial.data(), &infeasible);
+            interrupted.step(k);
+            bool saved = interrupted.saveCheckpoint(path);
+            interrupted.finish();
+
+            PrSolver resuming(problem);
+            configure(resuming, elite);
+            if (!saved || !resuming.loadCheckpoint(path)) {
+                std::cerr << "Can't checkpoint instance " << instance << " after " << k << " passes" << std::endl;
+                failures++;
+                continue;
+            }
+            resuming.solve(resumed.data(), &infeasible);
+            if (resumed != expected) {
+                std::cerr << "Instance " << instance << " resumed after " << k << " passes differs" << std::endl;
+                failures++;
+            }
+        }
+    }
+
+    // A checkpoint taken after the time limit leaves no time for the resumed solve
+    Problem problem = generateInstance(40, 3, 1);
+    std::vector<int> schedule(problem.njobs);
+    bool infeasible;
+    PrSolver interrupted(problem);
+    configure(interrupted, 0);
+    interrupted.begin(schedule.data(), &infeasible);
+    interrupted.step(1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    interrupted.saveCheckpoint(path);
+    interrupted.finish();
+    PrSolver resuming(problem);
+    configure(resuming, 0);
+    resuming.setTimeLimit(50);
+    resuming.loadCheckpoint(path);
+    resuming.begin(schedule.data(), &infeasible);
+    if (resuming.step(NPASSES) || resuming.getPassCount() != 0) {
+        std::cerr << "The resumed solve ran passes after its time limit" << std::endl;
+        failures++;
+    }
+    resuming.finish();
+
+    std::remove(path.c_str());
+    return failures == 0 ? 0 : 1;
+}
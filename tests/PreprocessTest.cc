@@ -0,0 +1,73 @@
+/********************************************************************************[PreprocessTest.cc]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+
+
+#include <iostream>
+#include <vector>
+
+#include "Solver.h"
+#include "TestInstance.h"
+
+using namespace RcpsptHeuristic;
+
+/**
+ * Computes the time windows of a problem with preprocessing on the given number of threads.
+ */
+static bool timeWindows(Problem& problem, int threads, std::vector<TimeWindow>& windows) {
+    std::vector<int> schedule(problem.njobs);
+    bool infeasible;
+    PrSolver solver(problem);
+    solver.setPasses(1);
+    solver.setThreads(threads);
+    solver.solve(schedule.data(), &infeasible);
+    windows.resize(problem.njobs);
+    return !infeasible && solver.getTimeWindows(windows.data());
+}
+
+/**
+ * Checks that preprocessing on several threads, which splits the wide levels of the precedence graph over the threads,
+ * computes the same time windows as preprocessing on a single thread. The instances have levels of about a hundred
+ * activities.
+ */
+int main() {
+    int failures = 0;
+    for (unsigned instance = 1; instance <= 4; instance++) {
+        Problem problem = generateInstance(200, 3, instance);
+        std::vector<TimeWindow> expected, windows;
+        if (!timeWindows(problem, 1, expected) || !timeWindows(problem, 4, windows)) {
+            std::cerr << "Instance " << instance << " has no time windows" << std::endl;
+            failures++;
+            continue;
+        }
+        for (int job = 0; job < problem.njobs; job++) {
+            if (windows[job].earliestStart != expected[job].earliestStart ||
+                windows[job].latestFinish != expected[job].latestFinish ||
+                windows[job].feasibleStarts != expected[job].feasibleStarts) {
+                std::cerr << "Instance " << instance << " differs in the time window of activity " << job << std::endl;
+                failures++;
+                break;
+            }
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,170 @@
+/************************************************************************************[RelinkTest.cc]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "Solver.h"
+#include "TestInstance.h"
+
+using namespace RcpsptHeuristic;
+
+static const int NPASSES = 100;
+static const int ELITE = 6;
+
+/**
+ * Reference serial schedule generation scheme that decodes an activity list from scratch, on its own copy of the
+ * capacities.
+ */
+class Decoder {
+public:
+    explicit Decoder(const Problem& problem)
+        : problem(problem), schedule(problem.njobs, -1), available(problem.nresources) {
+        for (int k = 0; k < problem.nresources; k++)
+            for (int t = 0; t < problem.horizon; t++) available[k].push_back(problem.capacity(k, t));
+        schedule[0] = 0;
+    }
+
+    /**
+     * Places an activity as early as possible, as the solver does for a listed activity.
+     *
+     * @return false if a predecessor is not placed or the activity does not fit within the horizon
+     */
+    bool place(int job) {
+        if (schedule[job] >= 0) return true;
+        int duration = problem.durations[job];
+        int finish = duration;
+        for (int predecessor : problem.predecessors[job]) {
+            if (schedule[predecessor] < 0) return false;
+            finish = std::max(finish, schedule[predecessor] + duration);
+        }
+        while (finish <= problem.horizon && !fits(job, finish)) finish++;
+        if (finish > problem.horizon) return false;
+        schedule[job] = finish;
+        for (int i = 0; i < problem.nused[job]; i++) {
+            int k = problem.used[job][i];
+            for (int t = 0; t < duration; t++) available[k][finish - duration + t] -= problem.requests[job][k][t];
+        }
+        return true;
+    }
+
+    const Problem& problem;
+    std::vector<int> schedule;
+
+private:
+    bool fits(int job, int finish) const {
+        int duration = problem.durations[job];
+        for (int i = 0; i < problem.nused[job]; i++) {
+            int k = problem.used[job][i];
+            for (int t = 0; t < duration; t++)
+                if (problem.requests[job][k][t] > available[k][finish - duration + t]) return false;
+        }
+        return true;
+    }
+
+    std::vector<std::vector<int>> available;
+};
+
+/**
+ * Follows the path from one elite schedule to another as the solver does, but decodes each intermediate activity list
+ * from scratch, and keeps the first schedule that improves on the incumbent.
+ */
+static void relink(const Problem& problem, const EliteSchedule& from, const EliteSchedule& to, std::vector<int>& best) {
+    int n = problem.njobs;
+    std::vector<int> list = from.order;
+    Decoder prefix(problem);
+    int p = 0;
+    while (true) {
+        while (p < n && list[p] == to.order[p]) {
+            if (!prefix.place(list[p++])) return;
+        }
+        if (p == n) return;
+        int q = (int)(std::find(list.begin() + p, list.end(), to.order[p]) - list.begin());
+        std::rotate(list.begin() + p, list.begin() + q, list.begin() + q + 1);
+        if (!prefix.place(list[p++])) return;
+        if (std::equal(list.begin() + p, list.end(), to.order.begin() + p)) return;
+
+        Decoder trial(problem);
+        bool placed = true;
+        for (int i = 0; placed && i < n; i++) placed = trial.place(list[i]);
+        if (placed && trial.schedule[n - 1] < best[n - 1]) best = trial.schedule;
+    }
+}
+
+/**
+ * Configures a single-threaded, reproducible solver with an elite pool.
+ */
+static void configure(PrSolver& solver, unsigned seed, bool relinking) {
+    solver.setPasses(NPASSES);
+    solver.setThreads(1);
+    solver.setSeed(seed);
+    solver.setElitePool(ELITE);
+    solver.setPathRelinking(relinking);
+}
+
+/**
+ * Checks that path relinking, which decodes each intermediate activity list from the state after the prefix that it
+ * shares with the previous one, finds the same schedule as decoding every intermediate list from scratch.
+ */
+int main() {
+    int failures = 0;
+    for (unsigned instance = 1; instance <= 8; instance++) {
+        Problem problem = generateInstance(30, 2, instance);
+        std::vector<int> expected(problem.njobs), relinked(problem.njobs);
+        bool infeasible;
+
+        // The same passes without relinking give the elite pool that the relinking starts from
+        PrSolver passes(problem);
+        configure(passes, instance, false);
+        if (!passes.solve(expected.data(), &infeasible)) {
+            std::cerr << "Instance " << instance << " was not solved" << std::endl;
+            failures++;
+            continue;
+        }
+        std::vector<EliteSchedule> members = passes.getElite();
+        std::vector<std::pair<int, int>> pairs;
+        for (int i = 0; i < (int)members.size(); i++) {
+            for (int j = i + 1; j < (int)members.size(); j++) {
+                pairs.emplace_back(i, j);
+                pairs.emplace_back(j, i);
+            }
+        }
+        std::stable_sort(pairs.begin(), pairs.end(), [&members](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+            return members[a.first].makespan + members[a.second].makespan <
+                   members[b.first].makespan + members[b.second].makespan;
+        });
+        for (const std::pair<int, int>& pair : pairs) relink(problem, members[pair.first], members[pair.second], expected);
+
+        PrSolver relinking(problem);
+        configure(relinking, instance, true);
+        relinking.solve(relinked.data(), &infeasible);
+        if (relinked != expected) {
+            std::cerr << "Instance " << instance << " relinks to makespan " << relinked[problem.njobs - 1]
+                      << " instead of " << expected[problem.njobs - 1] << std::endl;
+            failures++;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
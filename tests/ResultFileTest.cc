@@ -0,0 +1,84 @@
+/********************************************************************************[ResultFileTest.cc]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ResultFile.h"
+
+using namespace RcpsptHeuristic;
+
+/**
+ * Writes records with names of every length modulo 8 (so that the records end at every offset modulo 8 before the
+ * index), and checks that the reader returns them unchanged.
+ */
+int main() {
+    std::string path = "result_file_test.bin";
+    int failures = 0;
+    for (int nrecords = 1; nrecords <= 8; nrecords++) {
+        std::vector<std::string> names;
+        std::vector<std::vector<int>> schedules;
+        {
+            ResultWriter writer(path);
+            for (int i = 0; i < nrecords; i++) {
+                names.push_back("/instances/" + std::string(i * 3 + nrecords, 'x') + ".smt");
+                std::vector<int> schedule(i % 2 == 0 ? 32 : 5 + i);
+                for (int j = 0; j < (int)schedule.size(); j++) schedule[j] = j * 7 + i;
+                schedules.push_back(schedule);
+                bool found = i % 3 != 2;
+                writer.add(names[i], found ? ResultStatus::Found : ResultStatus::NoSolution, i * 11L,
+                           found ? schedule.data() : nullptr, (int)schedule.size());
+            }
+            if (!writer.close()) {
+                std::cerr << "Can't write " << path << std::endl;
+                return 1;
+            }
+        }
+
+        ResultReader reader(path);
+        if (!reader.isOpen() || (int)reader.size() != nrecords) {
+            std::cerr << "Can't read " << nrecords << " records" << std::endl;
+            failures++;
+            continue;
+        }
+        for (int i = 0; i < nrecords; i++) {
+            ResultRecord record = reader.get(i);
+            bool found = i % 3 != 2;
+            bool same = record.name == names[i] && record.milis == i * 11L &&
+                        record.status == (found ? ResultStatus::Found : ResultStatus::NoSolution);
+            if (found) {
+                same = same && record.njobs == (int)schedules[i].size() && record.makespan == schedules[i].back();
+                for (int j = 0; same && j < record.njobs; j++) same = record.schedule[j] == schedules[i][j];
+            }
+            else same = same && record.schedule == nullptr && record.makespan == -1;
+            if (!same) {
+                std::cerr << "Record " << i << " of " << nrecords << " differs" << std::endl;
+                failures++;
+            }
+        }
+    }
+    std::remove(path.c_str());
+    return failures == 0 ? 0 : 1;
+}
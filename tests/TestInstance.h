@@ -0,0 +1,107 @@
+/********************************************************************************[TestInstance.h]
+Copyright (c) 2022, Jelle Pleunes
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**************************************************************************************************/
+
+
+#ifndef RCPSPT_HEURISTIC_TEST_INSTANCE_H
+#define RCPSPT_HEURISTIC_TEST_INSTANCE_H
+
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Parser.h"
+
+namespace RcpsptHeuristic {
+
+/**
+ * Generates a random instance in the format of Hartmann (2013) (see Parser), so that the tests do not depend on
+ * instance files. Each activity has up to two successors among the later activities, and the source and the sink
+ * are linked to the activities without predecessors or successors.
+ *
+ * @param njobs the number of activities, including the dummy source and sink
+ * @param nresources the number of resources
+ * @param seed the seed of the generator
+ * @return the instance
+ */
+inline Problem generateInstance(int njobs, int nresources, unsigned seed) {
+    std::mt19937 eng(seed);
+    int sink = njobs - 1;
+    std::vector<std::vector<int>> successors(njobs);
+    std::vector<bool> hasPredecessor(njobs, false);
+    for (int job = 1; job < sink - 1; job++) {
+        int nsucc = (int)(eng() % 3);
+        for (int i = 0; i < nsucc; i++) {
+            int successor = job + 1 + (int)(eng() % (sink - 1 - job));
+            bool duplicate = false;
+            for (int other : successors[job]) duplicate = duplicate || other == successor;
+            if (duplicate) continue;
+            successors[job].push_back(successor);
+            hasPredecessor[successor] = true;
+        }
+    }
+    for (int job = 1; job < sink; job++) {
+        if (!hasPredecessor[job]) successors[0].push_back(job);
+        if (successors[job].empty()) successors[job].push_back(sink);
+    }
+
+    std::vector<int> durations(njobs, 0);
+    int horizon = 0;
+    for (int job = 1; job < sink; job++) horizon += durations[job] = 1 + (int)(eng() % 8);
+
+    std::ostringstream text;
+    text << "****\nfile with basedata : test\n****\n";
+    text << "jobs (incl. supersource/sink ): " << njobs << "\nhorizon : " << horizon << "\n";
+    text << "  - renewable : " << nresources << " R\n****\nPROJECT INFORMATION:\n1 " << njobs - 2 << " 0 0 0 0\n****\n";
+    text << "PRECEDENCE RELATIONS:\njobnr. #modes #successors successors\n";
+    for (int job = 0; job < njobs; job++) {
+        text << job + 1 << " 1 " << successors[job].size();
+        for (int successor : successors[job]) text << " " << successor + 1;
+        text << "\n";
+    }
+    text << "****\nREQUESTS/DURATIONS:\njobnr. mode duration R1\n----\n";
+    for (int job = 0; job < njobs; job++) {
+        text << job + 1 << " 1 " << durations[job];
+        if (durations[job] == 0) {
+            text << "\n";
+            continue;
+        }
+        for (int k = 0; k < nresources; k++) {
+            if (k > 0) text << "\n";
+            for (int t = 0; t < durations[job]; t++) text << " " << eng() % 6;
+        }
+        text << "\n";
+    }
+    text << "****\nRESOURCEAVAILABILITIES:\n";
+    for (int k = 0; k < nresources; k++) text << "R " << k + 1 << " ";
+    text << "\n";
+    for (int k = 0; k < nresources; k++) {
+        for (int t = 0; t < horizon; t++) text << 6 + eng() % 5 << " ";
+        text << "\n";
+    }
+    text << "****\n";
+    std::string data = text.str();
+    return Parser::parseProblemInstance(data.data(), data.size());
+}
+}
+
+#endif //RCPSPT_HEURISTIC_TEST_INSTANCE_H